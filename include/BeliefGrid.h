@@ -0,0 +1,103 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * What a robot knows about a tile, 2 bits per tile in a BeliefGrid.
+ * Blocked is the only state with both bits set, so the obstacles of 32 tiles are one AND away.
+ */
+enum class CellState : std::uint8_t {
+    Unknown = 0, /// Never observed (planned through as free)
+    Free = 1, /// Observed free
+    Goal = 2, /// Goal tile of the robot
+    Blocked = 3 /// Obstacle
+};
+
+/**
+ * Converts a CellState enum value to its string representation.
+ */
+inline const char* cellStateToString(CellState s) {
+    switch(s) {
+        case CellState::Unknown: return "unknown";
+        case CellState::Free: return "free";
+        case CellState::Goal: return "goal";
+        case CellState::Blocked: return "blocked";
+        default: return "invalid";
+    }
+}
+
+/**
+ * Sparse belief map: 2 bits per tile in 64x64-tile pages, shared copy-on-write between copies.
+ *
+ * Pages are grouped in blocks of 16x16 pages (1024x1024 tiles) under a small directory, so an
+ * untouched region costs nothing, not even a page table entry: a robot pays for the blocks and
+ * pages it wrote, whatever the size of the world. Unallocated pages read as Unknown.
+ *
+ * Copying a grid copies the directory only: both grids then share every block and page, and the
+ * first write to a shared block or page clones it. Robots copying the same prior therefore share
+ * it, and each one only owns what it discovered. A block or page is shared while its use count is
+ * above 1: copying a grid never writes to the source, so threads may copy the same prior at once.
+ */
+class BeliefGrid {
+    public:
+        static const int PAGE = 64; /// Page side, in tiles
+        static const int BLOCK = 16; /// Block side, in pages
+
+    private:
+        /// Row y of a page is words[2y] (tiles 0-31) and words[2y+1] (tiles 32-63), 2 bits per tile
+        struct Page {
+            std::uint64_t words[PAGE * 2] = {};
+        };
+        struct Block {
+            std::shared_ptr<Page> pages[BLOCK * BLOCK];
+        };
+
+        int cols = 0;
+        int rows = 0;
+        int blockCols = 0; /// Blocks per row of blocks
+        std::vector<std::shared_ptr<Block>> blocks; /// Directory, nullptr for an untouched block
+
+        const Page * findPage(int r, int c) const {
+            const Block * b = blocks[std::size_t(r >> 10) * blockCols + (c >> 10)].get();
+            return b ? b->pages[((r >> 6) & (BLOCK - 1)) * BLOCK + ((c >> 6) & (BLOCK - 1))].get() : nullptr;
+        }
+
+        /// Page of (r, c), cloned or allocated so this grid can write it
+        Page& writablePage(int r, int c);
+
+    public:
+        /**
+         * Sizes the grid with every tile Unknown (nothing is allocated).
+         */
+        void resize(int gridCols, int gridRows);
+
+        int getCols() const {return cols;}
+        int getRows() const {return rows;}
+
+        CellState get(int id) const {
+            int r = id / cols;
+            int c = id - r * cols;
+            const Page * p = findPage(r, c);
+            if(!p)
+                return CellState::Unknown;
+            std::uint64_t w = p->words[(r & (PAGE - 1)) * 2 + ((c >> 5) & 1)];
+            return CellState((w >> (2 * (c & 31))) & 3u);
+        }
+
+        bool isBlocked(int id) const {return get(id) == CellState::Blocked;}
+
+        void set(int id, CellState s);
+
+        /**
+         * Returns the obstacles of tiles [64w, 64w+64) of row r, one bit per tile (GridGraph::rowWord layout).
+         */
+        std::uint64_t blockedWord(int r, int w) const;
+
+        /// Pages written by this grid (shared pages excluded)
+        int getPageCount() const;
+
+        /// Heap memory owned by this grid: directory, and the blocks and pages it does not share
+        std::size_t getMemoryBytes() const;
+};
@@ -0,0 +1,72 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+/**
+ * Monotone integer priority queue (Dial's buckets) for shortest paths with small integer edge costs.
+ *
+ * Keys are distances: every key pushed must lie in [k, k + SPAN), where k is the last key popped.
+ * That holds for Dijkstra with edge costs below SPAN, since a node settled at k only pushes k + cost.
+ * The keys in that window are kept in SPAN circular buckets, so push is O(1) and pop only moves a
+ * cursor over the empty buckets: no comparison, no heap sift.
+ *
+ * Nodes are popped in key order (in LIFO order within a key). Stale entries are not removed: the search
+ * compares the key popped with the node's current distance.
+ */
+class BucketQueue {
+    public:
+        static const unsigned SPAN = 256; /// Edge costs must be below SPAN (CostLayer::MAX_COST is 255)
+
+    private:
+        std::vector<std::vector<int>> buckets; /// SPAN buckets, created by the first clear (maps that never run dial stay small)
+        unsigned cursor = 0; /// Smallest key that may still be in the queue
+        std::size_t count = 0;
+
+    public:
+        /**
+         * Empties the queue and moves the cursor back to key 0. The buckets keep their capacity.
+         * Must be called before the first push.
+         */
+        void clear(){
+            buckets.resize(SPAN);
+            for(auto& b : buckets)
+                b.clear();
+            cursor = 0;
+            count = 0;
+        }
+
+        bool empty() const {return count == 0;}
+        std::size_t size() const {return count;}
+
+        void push(unsigned key, int node){
+            buckets[key % SPAN].push_back(node);
+            count++;
+        }
+
+        /**
+         * Smallest key in the queue (the cursor moves to it). The queue must not be empty.
+         */
+        unsigned topKey(){
+            while(buckets[cursor % SPAN].empty())
+                cursor++;
+            return cursor;
+        }
+
+        /// Number of nodes of key (a key of the window [k, k + SPAN))
+        std::size_t countAt(unsigned key) const {return buckets[key % SPAN].size();}
+
+        /**
+         * Removes a node of the smallest key. The queue must not be empty.
+         * @param key Receives the key of the node
+         */
+        int pop(unsigned& key){
+            while(buckets[cursor % SPAN].empty())
+                cursor++;
+            std::vector<int>& b = buckets[cursor % SPAN];
+            int node = b.back();
+            b.pop_back();
+            count--;
+            key = cursor;
+            return node;
+        }
+};
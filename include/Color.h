@@ -0,0 +1,38 @@
+#pragma once
+#include <cstdint>
+
+/**
+ * Plain RGBA color used by the simulation core.
+ * It mirrors the few sf::Color values the project needs, so that Map and Tile
+ * can keep their appearance state without depending on SFML.
+ * The SFML view converts it when drawing.
+ */
+struct Color {
+    std::uint8_t r = 0; /// Red component
+    std::uint8_t g = 0; /// Green component
+    std::uint8_t b = 0; /// Blue component
+    std::uint8_t a = 255; /// Alpha component (255 = opaque)
+
+    constexpr Color() = default;
+    constexpr Color(std::uint8_t red, std::uint8_t green, std::uint8_t blue, std::uint8_t alpha = 255)
+        : r(red), g(green), b(blue), a(alpha) {}
+
+    bool operator==(const Color& o) const { return r == o.r && g == o.g && b == o.b && a == o.a; }
+    bool operator!=(const Color& o) const { return !(*this == o); }
+
+    static const Color Black;
+    static const Color White;
+    static const Color Red;
+    static const Color Green;
+    static const Color Blue;
+    static const Color Magenta;
+    static const Color Cyan;
+};
+
+inline constexpr Color Color::Black{0, 0, 0};
+inline constexpr Color Color::White{255, 255, 255};
+inline constexpr Color Color::Red{255, 0, 0};
+inline constexpr Color Color::Green{0, 255, 0};
+inline constexpr Color Color::Blue{0, 0, 255};
+inline constexpr Color Color::Magenta{255, 0, 255};
+inline constexpr Color Color::Cyan{0, 255, 255};
@@ -0,0 +1,65 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * Traversal cost of each tile of a map: entering tile v costs get(v), an integer in [1, 255].
+ *
+ * An empty layer is the uniform grid (every tile costs 1) and stores nothing. The bytes are either
+ * owned or viewed in place from external memory (a cost layer of a memory mapped MapFile), like the
+ * bits of a GridGraph; an external layer is copied into owned storage on its first change.
+ * Copies of a layer share the owned bytes until one of them is changed, so every robot's belief map
+ * can carry the costs of the true map for free. Costs are set while building a map, never while
+ * the copies are used from other threads.
+ * A stored 0 reads as 1, so a zero-filled layer is also uniform.
+ */
+class CostLayer {
+    private:
+        int cols = 0;
+        int rows = 0;
+        std::shared_ptr<std::vector<std::uint8_t>> owned; /// Owned costs, row-major (null while uniform or external)
+        const std::uint8_t * view = nullptr; /// Costs read: owned->data() or the external memory
+        std::shared_ptr<const void> external; /// Keeps the external memory alive
+
+    public:
+        static constexpr int MAX_COST = 255;
+
+        /**
+         * Back to the uniform layer (frees the costs).
+         */
+        void clear();
+
+        /**
+         * Sizes an owned layer and sets every tile to 'cost'.
+         */
+        void assign(int gridCols, int gridRows, std::uint8_t cost);
+
+        /**
+         * Views costs stored elsewhere (cols*rows bytes, row-major).
+         * @param owner Object keeping data alive (shared with the copies of this layer)
+         */
+        void attach(int gridCols, int gridRows, const std::uint8_t * data, std::shared_ptr<const void> owner);
+
+        /// True while every tile costs 1 and nothing is stored
+        bool isUniform() const {return view == nullptr;}
+        bool isExternal() const {return external != nullptr;}
+
+        std::uint8_t get(int id) const {
+            std::uint8_t c = view ? view[id] : 1;
+            return c ? c : 1;
+        }
+
+        /**
+         * Sets the cost of a tile (0 is stored as 1). A uniform layer is first sized to cols x rows.
+         */
+        void set(int gridCols, int gridRows, int id, std::uint8_t cost);
+
+        /**
+         * Copies the costs (cols*rows bytes, 1 for a uniform layer).
+         */
+        void copyTo(std::vector<std::uint8_t>& out, int gridCols, int gridRows) const;
+
+        /// Heap memory used by the layer (external memory not included; shared bytes are counted by every copy)
+        std::size_t getMemoryBytes() const {return owned ? owned->capacity() : 0;}
+};
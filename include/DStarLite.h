@@ -0,0 +1,103 @@
+#pragma once
+#include <vector>
+#include <queue>
+#include <utility>
+#include "SearchStats.h"
+#include "NodeArray.h"
+
+class Map;
+
+/**
+ * Incremental shortest path planner (D* Lite, Koenig & Likhachev) on the 4-connected tile grid of a Map.
+ *
+ * The search runs backwards from the goal and keeps its g/rhs values between calls.
+ * When a tile changes (e.g. a sensor marks it as an obstacle) only the vertices whose
+ * distance depends on that tile are repaired, instead of recomputing the whole search.
+ * The start can move between calls (the robot walks along its path).
+ */
+class DStarLite {
+    private:
+        /// Priority of a vertex: (min(g,rhs) + h + km, min(g,rhs)), compared lexicographically
+        typedef std::pair<float, float> Key;
+        typedef std::pair<Key, int> Entry;
+
+        const Map * map; /// Map whose obstacles define the edge costs
+        int cols = 0;
+        int rows = 0;
+        int start = -1;
+        int goal = -1;
+        int lastStart = -1; /// Start used by the previous repair (to update km)
+        float km = 0.0f; /// Key modifier accumulated while the start moves
+
+        /// Per-tile state: chunked on a chunked map, so memory follows the searched area
+        NodeArray<float> g;   /// Current distance estimate to the goal
+        NodeArray<float> rhs; /// One-step lookahead distance to the goal
+
+        /// Open list with lazy deletion: an entry is valid only if the vertex is open with the same key
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+        NodeArray<Key> openKey;
+        NodeArray<char> inOpen;
+
+        SearchStats lastStats; /// Work done by the last computeShortestPath
+        SearchStats fullStats; /// Work done by the initial (full) search
+
+        bool isBlocked(int id) const;
+        float heuristic(int a, int b) const;
+        float cost(int a, int b) const;
+        Key calculateKey(int s) const;
+        void insert(int s, Key k);
+        void updateVertex(int s);
+        float bestSuccessor(int s, int * next) const;
+        void computeShortestPath();
+
+        /// Calls f(neighbor) for each in-bounds 4-connected neighbor of id
+        template<typename F>
+        void forEachNeighbor(int id, F f) const {
+            int r = id / cols;
+            int c = id % cols;
+            if(r > 0) f(id - cols);
+            if(r < rows - 1) f(id + cols);
+            if(c > 0) f(id - 1);
+            if(c < cols - 1) f(id + 1);
+        }
+
+    public:
+        /**
+         * @param m Map to plan on. It must outlive the planner.
+         */
+        explicit DStarLite(const Map * m = nullptr) : map(m) {}
+
+        void setMap(const Map * m){map = m; goal = -1;}
+
+        /**
+         * Discards any previous state and runs a full search from start to goal.
+         */
+        void reset(int startTile, int goalTile);
+
+        /**
+         * Notifies that the occupancy of a tile changed: the tile and its neighbors are queued for repair.
+         * The repair itself runs at the next call to plan().
+         */
+        void notifyTileChanged(int id);
+
+        /**
+         * Repairs the search for the (possibly moved) start and extracts the path.
+         * @param startTile Current tile of the robot
+         * @return Vector of tile indices from start to goal, or {goal} if the goal is unreachable (same format as Map::dijkstra)
+         */
+        std::vector<int> plan(int startTile);
+
+        /// True if the planner has a search state for this goal
+        bool hasGoal(int goalTile) const {return goal == goalTile && goal >= 0;}
+
+        /// Work done by the last repair (or by the initial search, right after reset)
+        const SearchStats& getLastStats() const {return lastStats;}
+
+        /// Work done by the initial full search, as a reference for the repairs
+        const SearchStats& getFullSearchStats() const {return fullStats;}
+
+        /// Heap memory of the per-tile search state
+        std::size_t getMemoryBytes() const {
+            return g.getMemoryBytes() + rhs.getMemoryBytes() + openKey.getMemoryBytes() + inOpen.getMemoryBytes();
+        }
+};
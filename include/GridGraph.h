@@ -0,0 +1,167 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "BeliefGrid.h"
+
+/**
+ * Implicit graph of a 4-connected tile grid.
+ *
+ * Occupancy is stored as one bit per tile (1 = obstacle), each row padded to whole 64-bit words.
+ * Edges are not stored: forEachNeighbor generates them on the fly, so planners can iterate the graph
+ * without any per-node allocation. The edge layout is the same as Map::buildGraph: an obstacle has no
+ * outgoing edges and every edge between two free neighbors has weight 1 (Map's planners replace it
+ * with the cost of the tile entered, see CostLayer).
+ *
+ * The bits are either owned by the grid or viewed in place from external memory (e.g. a memory
+ * mapped map file, see MapFile). An external grid is copied into owned storage on its first change.
+ *
+ * A grid can also be chunked (see resizeChunked): the tiles are stored in a BeliefGrid, 2 bits per tile
+ * (unknown, free, goal, blocked) in 64x64-tile pages allocated on first write and shared copy-on-write
+ * between copies of the grid. Untouched pages read as unknown, which the planners treat as free, so a
+ * mostly-unknown belief map over a huge world costs memory in proportion to what was discovered, and
+ * robots copying the same prior share it. rowWord extracts the obstacle bits of a page row, so the
+ * 64-tile scans work the same on both layouts.
+ */
+class GridGraph {
+    private:
+        int cols = 0; /// Number of columns
+        int rows = 0; /// Number of rows
+        int wordsPerRow = 0; /// 64-bit words used by each row
+        std::vector<std::uint64_t> bits; /// Owned occupancy bits, row-major (empty while viewing external memory)
+        const std::uint64_t * words = nullptr; /// Bits actually read: bits.data() or the external memory
+        std::shared_ptr<const void> external; /// Keeps the external memory alive
+
+        bool chunked = false; /// Tiles stored in 'cells' instead of rows of bits
+        BeliefGrid cells; /// Chunked layout
+
+        /// Copies external bits into owned storage before the first change
+        void makeOwned();
+
+    public:
+        GridGraph() = default;
+        GridGraph(int gridCols, int gridRows){resize(gridCols, gridRows);}
+        GridGraph(const GridGraph& o);
+        GridGraph(GridGraph&& o) noexcept;
+        GridGraph& operator=(const GridGraph& o);
+        GridGraph& operator=(GridGraph&& o) noexcept;
+
+        /**
+         * Resizes the grid and marks every tile as free.
+         */
+        void resize(int gridCols, int gridRows);
+
+        /**
+         * Resizes the grid to the chunked layout and marks every tile as unknown (nothing is allocated).
+         */
+        void resizeChunked(int gridCols, int gridRows);
+
+        /**
+         * Views occupancy bits stored elsewhere, in the same layout (rows of getWordsPerRow() words).
+         * @param gridCols Number of columns
+         * @param gridRows Number of rows
+         * @param data First word of the bits
+         * @param owner Object keeping data alive (shared with the copies of this grid)
+         */
+        void attach(int gridCols, int gridRows, const std::uint64_t * data, std::shared_ptr<const void> owner);
+
+        /// True while the bits are viewed from external memory
+        bool isExternal() const {return external != nullptr;}
+
+        /// True if the tiles are stored in a BeliefGrid (pages allocated on first use)
+        bool isChunked() const {return chunked;}
+
+        /**
+         * Returns the belief state of a tile: the BeliefGrid state on a chunked grid,
+         * Blocked or Free on the other layouts (every tile is known).
+         */
+        CellState getCellState(int id) const {
+            if(chunked)
+                return cells.get(id);
+            return isBlocked(id) ? CellState::Blocked : CellState::Free;
+        }
+
+        /**
+         * Sets the belief state of a tile. Only the blocked bit is kept on the non-chunked layouts.
+         */
+        void setCellState(int id, CellState s){
+            if(chunked)
+                cells.set(id, s);
+            else
+                setBlocked(id, s == CellState::Blocked);
+        }
+
+        /// First word of the occupancy bits (rows of getWordsPerRow() words); nullptr for a chunked grid
+        const std::uint64_t * data() const {return chunked ? nullptr : words;}
+
+        /**
+         * Copies the occupancy in the row layout of data() (rows of getWordsPerRow() words), whatever the storage.
+         * @param out At least getWordsPerRow() * getRows() words
+         */
+        void copyWords(std::uint64_t * out) const;
+
+        /// Pages written by a chunked grid (pages shared with other copies excluded)
+        int getChunkCount() const {return chunked ? cells.getPageCount() : 0;}
+
+        /// Heap memory owned by the grid (external memory and shared pages not included)
+        std::size_t getMemoryBytes() const {
+            return bits.capacity() * sizeof(std::uint64_t) + (chunked ? cells.getMemoryBytes() : 0);
+        }
+
+        int getCols() const {return cols;}
+        int getRows() const {return rows;}
+        int size() const {return cols * rows;}
+        int getWordsPerRow() const {return wordsPerRow;}
+
+        bool isBlocked(int id) const {
+            if(chunked)
+                return cells.isBlocked(id);
+            int r = id / cols;
+            int c = id - r * cols;
+            return (rowWord(r, c >> 6) >> (c & 63)) & 1u;
+        }
+
+        void setBlocked(int id, bool blocked){
+            if(external)
+                makeOwned();
+            if(chunked){
+                /// Clearing an obstacle leaves a known free tile; other states are kept
+                if(blocked)
+                    cells.set(id, CellState::Blocked);
+                else if(cells.isBlocked(id))
+                    cells.set(id, CellState::Free);
+                return;
+            }
+            int r = id / cols;
+            int c = id - r * cols;
+            std::uint64_t mask = std::uint64_t(1) << (c & 63);
+            std::uint64_t& w = bits[std::size_t(r) * wordsPerRow + (c >> 6)];
+            w = blocked ? (w | mask) : (w & ~mask);
+        }
+
+        /**
+         * Returns the w-th 64-bit word of row r: bit i is column w*64 + i (padding bits are 0).
+         * Used by scans that test 64 tiles at once.
+         */
+        std::uint64_t rowWord(int r, int w) const {
+            if(chunked)
+                return cells.blockedWord(r, w);
+            return words[std::size_t(r) * wordsPerRow + w];
+        }
+
+        /**
+         * Calls f(neighbor, weight) for each edge leaving id (up, down, left, right).
+         * No edge leaves an obstacle, and no edge enters one.
+         */
+        template<typename F>
+        void forEachNeighbor(int id, F&& f) const {
+            if(isBlocked(id))
+                return;
+            int r = id / cols;
+            int c = id - r * cols;
+            if(r > 0 && !isBlocked(id - cols)) f(id - cols, 1.0f);
+            if(r < rows - 1 && !isBlocked(id + cols)) f(id + cols, 1.0f);
+            if(c > 0 && !isBlocked(id - 1)) f(id - 1, 1.0f);
+            if(c < cols - 1 && !isBlocked(id + 1)) f(id + 1, 1.0f);
+        }
+};
@@ -0,0 +1,22 @@
+#pragma once
+#include <cstdlib>
+
+/**
+ * Heuristic estimating the cost of the path between two tiles of a grid with 'cols' columns.
+ * It must never overestimate the real cost, otherwise A* may return a non optimal path.
+ */
+typedef float (*Heuristic)(int from, int to, int cols);
+
+/**
+ * Manhattan distance: exact lower bound on the 4-connected grid with unit edge weights.
+ */
+inline float manhattanHeuristic(int from, int to, int cols){
+    return float(std::abs(from / cols - to / cols) + std::abs(from % cols - to % cols));
+}
+
+/**
+ * Zero heuristic: A* with it behaves like Dijkstra with early termination on the goal.
+ */
+inline float zeroHeuristic(int, int, int){
+    return 0.0f;
+}
@@ -0,0 +1,108 @@
+#pragma once
+#include <utility>
+#include <vector>
+#include "SearchStats.h"
+
+class Map;
+
+/**
+ * Hierarchical path planner (HPA*, Botea, Müller & Schaeffer) on the 4-connected tile grid of a Map.
+ *
+ * The grid is split into square clusters. Where two neighbor clusters share free border tiles,
+ * transitions are placed (one in the middle of a short opening, one at each end of a long one):
+ * their tiles are the nodes of an abstract graph, linked across the border (cost 1) and, inside
+ * a cluster, by the precomputed shortest distance between them. A query connects start and goal
+ * to the nodes of their clusters, searches the small abstract graph with A*, and refines each
+ * abstract edge into tiles with a search bounded to one cluster.
+ *
+ * When a tile changes (notifyTileChanged) only its cluster is rebuilt, plus the cluster across
+ * the border if the tile lies on one. Paths are near-optimal (they go through transitions).
+ * The returned path has the same format as Map::dijkstra: every tile from start to goal, or {goal}.
+ */
+class HierarchicalPlanner {
+    private:
+        /// Abstract graph of one cluster
+        struct Cluster {
+            int x0 = 0, y0 = 0, width = 0, height = 0; /// Tiles covered by the cluster
+            std::vector<int> nodes; /// Tiles of the abstract nodes (border tiles with a transition)
+            std::vector<std::pair<int,int>> links; /// (local node, tile across the border) for each inter-cluster edge
+            std::vector<int> distances; /// nodes.size()^2 shortest distances inside the cluster (-1 if none)
+            std::vector<std::pair<int,int>> rightTransitions; /// (tile here, tile in the right neighbor)
+            std::vector<std::pair<int,int>> bottomTransitions; /// (tile here, tile in the bottom neighbor)
+        };
+
+        const Map * map; /// Map whose obstacles define the grid
+        int clusterSize; /// Side of a cluster, in tiles
+        int cols = 0;
+        int rows = 0;
+        int clustersX = 0; /// Clusters per row
+        int clustersY = 0; /// Clusters per column
+        std::vector<Cluster> clusters;
+        std::vector<int> nodeBase; /// Global id of the first node of each cluster (prefix sums, one extra entry)
+
+        std::vector<int> pendingTiles; /// Tiles changed since the last query
+        std::vector<char> rightDirty; /// The transitions on the right border of the cluster must be recomputed
+        std::vector<char> bottomDirty; /// The transitions on the bottom border of the cluster must be recomputed
+        std::vector<char> clusterDirty; /// The nodes/distances of the cluster must be recomputed
+
+        /// Scratch buffers of the searches bounded to one cluster (local tile indices)
+        std::vector<int> localDist;
+        std::vector<int> localParent;
+        std::vector<int> localQueue;
+
+        SearchStats lastStats; /// Work done by the last query (abstract search and refinement)
+        long rebuiltClusters = 0; /// Clusters rebuilt since the planner was (re)built
+
+        bool isBlocked(int id) const;
+        int clusterOf(int tile) const {return (tile / cols) / clusterSize * clustersX + (tile % cols) / clusterSize;}
+        int findNode(int cluster, int tile) const;
+
+        void build();
+        void applyChanges();
+        void findTransitions(int cluster, bool right);
+        void rebuildCluster(int cluster);
+
+        /**
+         * Breadth-first search from source, bounded to the cluster: fills localDist/localParent.
+         */
+        void clusterSearch(int cluster, int source);
+
+        /**
+         * Appends the tiles of the in-cluster shortest path from 'from' to 'to' (excluding 'from').
+         */
+        void refine(int cluster, int from, int to, std::vector<int>& path);
+
+    public:
+        /**
+         * @param m Map to plan on. It must outlive the planner.
+         * @param size Side of a cluster, in tiles
+         */
+        explicit HierarchicalPlanner(const Map * m = nullptr, int size = 16) : map(m), clusterSize(size) {}
+
+        void setMap(const Map * m){map = m; cols = 0;}
+
+        /// Changes the cluster side: the abstraction is rebuilt at the next query
+        void setClusterSize(int size){clusterSize = size > 0 ? size : 1; cols = 0;}
+        int getClusterSize() const {return clusterSize;}
+
+        /**
+         * Notifies that the occupancy of a tile changed. The affected cluster is rebuilt at the next query.
+         */
+        void notifyTileChanged(int id){pendingTiles.push_back(id);}
+
+        /**
+         * Computes a path between two tiles.
+         * @param start Index of the start tile
+         * @param goal Index of the goal tile
+         * @return Vector of tile indices from start to goal, or {goal} if unreachable
+         */
+        std::vector<int> findPath(int start, int goal);
+
+        /// Work done by the last query (expanded/pushed count abstract nodes and refined tiles)
+        const SearchStats& getLastStats() const {return lastStats;}
+
+        int getClusterCount() const {return int(clusters.size());}
+        int getNodeCount() const {return nodeBase.empty() ? 0 : nodeBase.back();}
+        /// Clusters rebuilt so far (all of them at the first query, then only the ones hit by changes)
+        long getRebuiltClusters() const {return rebuiltClusters;}
+};
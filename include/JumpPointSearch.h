@@ -0,0 +1,50 @@
+#pragma once
+#include <vector>
+#include "GridGraph.h"
+#include "SearchStats.h"
+
+/**
+ * Jump Point Search for the 4-connected, uniform-cost tile grid.
+ *
+ * Shortest paths are taken in a canonical order (vertical moves first, horizontal moves after),
+ * so that most of the grid can be skipped: the search only stops on jump points, i.e. tiles where
+ * an obstacle forces a turn, or where the goal is in sight. Horizontal jumps scan 64 tiles per step
+ * on the occupancy words of the GridGraph.
+ *
+ * The returned path has the same format as Map::dijkstra: every tile from start to goal is listed
+ * (the straight segments between jump points are filled in), or {goal} when there is no path.
+ */
+class JumpPointSearch {
+    private:
+        const GridGraph * grid = nullptr;
+        int cols = 0;
+        int rows = 0;
+        int goal = -1;
+
+        /// Scratch buffers, reused between searches
+        std::vector<float> distance;
+        std::vector<int> previous;
+        std::vector<unsigned char> directions; /// Directions each node may be expanded in (bit mask)
+        std::vector<char> closed;
+
+        SearchStats lastStats; /// Work done by the last search
+
+        bool isFree(int c, int r) const {
+            return c >= 0 && c < cols && r >= 0 && r < rows && !grid->isBlocked(r * cols + c);
+        }
+        int jumpHorizontal(int c, int r, int dx) const;
+        int jumpVertical(int c, int r, int dy) const;
+
+    public:
+        /**
+         * Computes the shortest path between two tiles of the grid.
+         * @param g Occupancy of the map
+         * @param start Index of the start tile
+         * @param goalTile Index of the goal tile
+         * @return Vector of tile indices from start to goal, or {goal} if unreachable
+         */
+        std::vector<int> findPath(const GridGraph& g, int start, int goalTile);
+
+        /// Work done by the last search (expanded/pushed count jump points, not tiles)
+        const SearchStats& getLastStats() const {return lastStats;}
+};
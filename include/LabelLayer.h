@@ -0,0 +1,45 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include "Map.h"
+
+/**
+ * Debug layer showing the index of every tile, centered in the tile.
+ *
+ * The glyph quads of all the labels are laid out once into a vertex array textured with the font
+ * atlas, and drawn in one call. They are only laid out again when the grid changes (size or tile size).
+ * The layer can be shown/hidden at runtime.
+ */
+class LabelLayer : public sf::Drawable {
+    private:
+        const sf::Font * font;
+        unsigned characterSize;
+        sf::Color color;
+        sf::VertexArray vertices;
+        bool visible = true;
+
+        /// Grid the labels were laid out for
+        int builtCols = -1;
+        int builtRows = -1;
+        int builtTileSize = -1;
+
+        void rebuild(const Map& map);
+
+        void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+
+    public:
+        /**
+         * @param f Font of the labels. It must outlive the layer.
+         * @param size Character size in pixels
+         * @param c Text color
+         */
+        LabelLayer(const sf::Font& f, unsigned size = 12, sf::Color c = sf::Color::Red);
+
+        /**
+         * Lays the labels out again if the grid of the map differs from the cached one.
+         */
+        void update(const Map& map);
+
+        void setVisible(bool b){visible = b;}
+        bool isVisible() const {return visible;}
+        void toggle(){visible = !visible;}
+};
@@ -0,0 +1,53 @@
+#pragma once
+#include <vector>
+#include "GridGraph.h"
+
+/**
+ * Landmark distance tables for the ALT heuristic (A*, Landmarks, Triangle inequality; Goldberg & Harrelson).
+ *
+ * K landmark tiles are picked far apart (farthest-point selection) and the exact distance from each
+ * of them to every tile is stored. By the triangle inequality |d(L,to) - d(L,from)| never exceeds
+ * d(from,to), so the largest of these differences is an admissible, consistent heuristic that is
+ * much tighter than the Manhattan distance around obstacles.
+ *
+ * The tables stay admissible while tiles only become obstacles (distances can only grow);
+ * they must be rebuilt when an obstacle is removed. Memory: K ints per tile.
+ */
+class Landmarks {
+    private:
+        int cells = 0; /// Tiles of the grid the tables were built for
+        std::vector<int> landmarks; /// Tile of each landmark
+        std::vector<int> distances; /// distances[k * cells + t]: distance from landmark k to tile t (-1 if unreachable)
+
+        /// Breadth-first distances from source over the free tiles, written to out
+        static void distancesFrom(const GridGraph& grid, int source, int * out);
+
+    public:
+        /**
+         * Picks the landmarks and computes their distance tables.
+         * @param grid Occupancy of the map
+         * @param count Number of landmarks (fewer if the grid has fewer free tiles)
+         */
+        void build(const GridGraph& grid, int count);
+
+        void clear(){landmarks.clear(); distances.clear(); cells = 0;}
+        bool isBuilt() const {return !landmarks.empty();}
+        int getCount() const {return int(landmarks.size());}
+        const std::vector<int>& getLandmarks() const {return landmarks;}
+
+        /**
+         * Lower bound on the distance between two tiles (0 if no landmark reaches both).
+         */
+        float heuristic(int from, int to) const {
+            int best = 0;
+            for(int k = 0; k < int(landmarks.size()); k++){
+                const int * d = &distances[std::size_t(k) * cells];
+                if(d[from] < 0 || d[to] < 0)
+                    continue;
+                int diff = d[to] > d[from] ? d[to] - d[from] : d[from] - d[to];
+                if(diff > best)
+                    best = diff;
+            }
+            return float(best);
+        }
+};
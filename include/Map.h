@@ -1,12 +1,22 @@
 #pragma once
-#include <SFML/Graphics.hpp>
 #include <vector>
 #include <iostream>
 #include "Tile.h"
+#include "SearchStats.h"
+#include "Heuristics.h"
+#include "GridGraph.h"
+#include "Landmarks.h"
+#include "PathCache.h"
+#include "CostLayer.h"
+#include "BucketQueue.h"
 #include <limits>
 
 /**
- * Represents a grid-based map made of tiles, used for robot pathfinding and rendering
+ * Represents a grid-based map made of tiles, used for robot pathfinding.
+ * The map has no rendering dependency: the SFML view (SfmlView.h) draws it from the tiles' state.
+ *
+ * A map can also be tile-less (see fromOccupancy): only the occupancy grid exists, so huge maps
+ * (e.g. loaded from a MapFile) cost one bit per tile. Color calls are ignored on such a map.
  */
 class Map{
     private: 
@@ -15,12 +25,50 @@ class Map{
         int rows; /// Number of rows in the grid
         int cols; /// Number of columns in the grid
 
+        /**
+         * Implicit graph over the occupancy bits of the tiles, used by the planners.
+         * Kept in sync with the tile types by setTileType.
+         */
+        GridGraph grid;
+
+        /**
+         * Traversal cost of each tile (uniform until a cost is set). Edge u -> v costs the cost of v.
+         */
+        CostLayer costs;
+
         /**
          * Graph representation of the map as an adjacency list. 
          * Each node is a tile index; edges connect traversable neighbors. 
+         * Only materialized by buildGraph (compatibility/debug path): the planners use grid.
          */
         std::vector<std::vector<std::pair<int,float>>> graph; 
 
+        SearchStats lastSearchStats; /// Work done by the last dijkstra/aStar call
+
+        unsigned long version = 0; /// Incremented each time the occupancy changes
+        Landmarks landmarks; /// ALT distance tables (see preprocessLandmarks)
+        PathCache pathCache; /// Paths of the last queries (disabled until setPathCacheSize)
+        BucketQueue buckets; /// Queue of dial, kept to reuse its buckets
+
+        std::vector<int> dirtyTiles; /// Tiles whose type or colors changed since the last clearDirtyTiles
+        std::vector<char> dirtyFlags; /// dirtyFlags[i] is 1 if tile i is already in dirtyTiles
+
+        /**
+         * Records that the appearance of a tile changed (each tile is listed at most once).
+         */
+        void markDirty(int id);
+
+        /**
+         * Returns the cached path from start to goal for the current version, if any (the search stats are zeroed).
+         */
+        bool lookupPath(int start, int goal, std::vector<int>& path);
+
+        /**
+         * A* with any heuristic callable h(node) estimating the distance from node to goal.
+         */
+        template<typename H>
+        std::vector<int> aStarSearch(int start, int goal, H h);
+
     public: 
         /**
          * Constructs a Map with the specified windows dimension
@@ -32,24 +80,100 @@ class Map{
         /// Default constructor for cloning
         Map() : tilesSize(50), rows(0), cols(0) {}
 
+        /**
+         * Creates a map with an explicit grid size, independent of any window.
+         * @param gridCols Number of columns
+         * @param gridRows Number of rows
+         */
+        static Map fromGrid(int gridCols, int gridRows);
+
+        /**
+         * Creates a tile-less map over an occupancy grid (the grid is shared, not copied, if it views a file).
+         * @param occupancy Occupancy of the map
+         * @param tileSize Size of each tile in pixels
+         */
+        static Map fromOccupancy(const GridGraph& occupancy, int tileSize = 50);
+
+        /**
+         * Returns true if the map has a Tile per cell (false for maps made by fromOccupancy).
+         */
+        bool hasTiles() const {return !tiles.empty();}
+
+        /**
+         * Creates the tiles of a tile-less map from its occupancy, so it can be drawn and edited.
+         * Does nothing if the map already has tiles.
+         */
+        void createTiles();
+
         /**
          * Creates a copy of the map structure without obstacles. 
-         * @return A new Map object with same grid but only empty tiles. 
+         * @return A new Map object with same grid but only empty tiles (tile-less and chunked if this map is tile-less). 
          */
         Map cloneStructureWithoutObstacles() const; 
 
         /**
-         *  Returns a reference to the vector of tiles.
+         * Creates a blank belief map for a robot: tile-less, every tile unknown (see GridGraph::resizeChunked),
+         * same size and tile costs. Nothing is allocated per tile: copies of it (one per robot) share their
+         * pages until they write them. A map within one BeliefGrid page keeps the dense layout (every tile free).
+         */
+        Map cloneBelief() const;
+
+        /**
+         *  Returns a const reference to the vector of tiles.
+         *  Tiles are modified through setTileType/setTileFillColor, so the occupancy grid stays in sync.
+         */
+        const std::vector<Tile>& getTiles() const;
+
+        /**
+         * Sets the type of a tile (and its color) and updates the occupancy grid.
+         * On a tile-less map only the occupancy changes (Obstacle or not).
+         * @param id Tile index.
+         * @param type New tile type.
+         */
+        void setTileType(int id, TileType type);
+
+        /**
+         * Returns what the map knows about a tile (unknown, free, goal or blocked, see GridGraph::getCellState).
+         */
+        CellState getCellState(int id) const {return grid.getCellState(id);}
+
+        /**
+         * Records what a robot knows about a tile. Blocked makes it an obstacle and any other state
+         * clears an obstacle (as setTileType does); otherwise the occupancy does not change.
+         */
+        void setCellState(int id, CellState s);
+
+        /**
+         * Sets the fill color of a tile without changing its type.
+         * @param id Tile index.
+         * @param c Color to set.
+         */
+        void setTileFillColor(int id, Color c);
+
+        /**
+         * Returns the tiles whose type or colors changed since the last clearDirtyTiles call.
+         * A renderer uses it to update only those tiles.
+         */
+        const std::vector<int>& getDirtyTiles() const {return dirtyTiles;}
+
+        /**
+         * Empties the dirty tile list, once the renderer has caught up with the map.
+         */
+        void clearDirtyTiles();
+
+        /**
+         * Returns the implicit graph used by the planners.
          */
-        std::vector<Tile>& getTiles(); 
+        const GridGraph& getGrid() const {return grid;}
 
         /**
-         * Builds the graph structure representing walkable tile connections.
+         * Builds the adjacency list from the occupancy grid.
+         * Only needed by getGraph/printGraph: the planners iterate the implicit grid graph.
          */
         void buildGraph();
 
         /**
-        *  Returns a const reference to the adjacency list.
+        *  Returns a const reference to the adjacency list (compatibility/debug path, see buildGraph).
         */
         const std::vector<std::vector<std::pair<int,float>>>& getGraph() const;
 
@@ -58,11 +182,6 @@ class Map{
          */
         void printGraph() const; 
         
-        /**
-         * Draws all tiles to the given SFML window
-         */
-        void draw(sf::RenderWindow& window) const;
-        
         /**
          * Computes the shortest path between two tiles using Dijkstra's algorith
          * @param start Index of the start tile 
@@ -70,18 +189,96 @@ class Map{
          * @return Vector of tile indices representing the path
          */
         std::vector<int> dijkstra(int start, int goal);
+
+        /**
+         * Computes the shortest path between two tiles with Dijkstra on a monotone bucket queue (Dial):
+         * the costs are small integers, so nodes are settled bucket by bucket instead of through a heap.
+         * Like aStar, the search stops as soon as the goal is settled.
+         * @param start Index of the start tile
+         * @param goal Index of the goal tile
+         * @return Vector of tile indices representing the path (same format as dijkstra)
+         */
+        std::vector<int> dial(int start, int goal);
+
+        /**
+         * Computes the shortest path between two tiles using A*.
+         * Unlike dijkstra, the search stops as soon as the goal is settled and skips stale queue entries.
+         * @param start Index of the start tile
+         * @param goal Index of the goal tile
+         * @param h Heuristic guiding the search (Manhattan distance for the 4-connected grid)
+         * @return Vector of tile indices representing the path (same format as dijkstra)
+         */
+        std::vector<int> aStar(int start, int goal, Heuristic h = manhattanHeuristic);
+
+        /**
+         * A* guided by the landmark (ALT) heuristic, or by the Manhattan distance if preprocessLandmarks was not run.
+         * @param start Index of the start tile
+         * @param goal Index of the goal tile
+         * @return Vector of tile indices representing the path (same format as dijkstra)
+         */
+        std::vector<int> aStarLandmarks(int start, int goal);
+
+        /**
+         * Picks 'count' landmarks and stores their distance tables, for aStarLandmarks.
+         * The tables stay valid while obstacles are only added; removing one discards them.
+         */
+        void preprocessLandmarks(int count);
+
+        const Landmarks& getLandmarks() const {return landmarks;}
+
+        /**
+         * Enables the LRU path cache of dijkstra/aStar/aStarLandmarks, keyed by (start, goal, version).
+         * @param maxPaths Number of paths kept (0 disables the cache)
+         */
+        void setPathCacheSize(std::size_t maxPaths){pathCache.setCapacity(maxPaths);}
+
+        const PathCache& getPathCache() const {return pathCache;}
+
+        /**
+         * Sets the traversal cost of a tile: entering it costs 'cost' (1 to 255) instead of 1.
+         * dijkstra, aStar, aStarLandmarks, dial and buildGraph use the costs; JumpPointSearch, DStarLite and
+         * HierarchicalPlanner assume every tile costs 1.
+         */
+        void setTileCost(int id, std::uint8_t cost);
+
+        std::uint8_t getTileCost(int id) const {return costs.get(id);}
+
+        /**
+         * Replaces the whole cost layer (an empty CostLayer makes the map uniform again).
+         */
+        void setCosts(const CostLayer& layer);
+
+        const CostLayer& getCosts() const {return costs;}
+
+        /**
+         * Makes the tiles near obstacles more expensive, so paths keep their distance when they can:
+         * a free tile d steps away from the closest obstacle (1 <= d <= radius) costs penalty * (radius + 1 - d) more.
+         * Costs saturate at CostLayer::MAX_COST.
+         */
+        void addObstaclePenalty(int radius, int penalty);
+
+        /**
+         * Returns the occupancy version: it changes every time a tile becomes or stops being an obstacle
+         * or a tile cost changes.
+         */
+        unsigned long getVersion() const {return version;}
+
+        /**
+         * Returns the work done by the last search run on this map.
+         */
+        const SearchStats& getLastSearchStats() const {return lastSearchStats;}
         
         
-        int getTileSize(){return tilesSize;}
-        int getCols(){return cols;}
-        int getRows(){return rows;}
+        int getTileSize() const {return tilesSize;}
+        int getCols() const {return cols;}
+        int getRows() const {return rows;}
         
         /**
          * Sets the border color of a specific tile.
          * @param c Color to set.
          * @param id Tile index.
          */        
-        void setBorderColorTile(sf::Color c, int id);
+        void setBorderColorTile(Color c, int id);
         
         /**
         * Highlights a path with a distinct color.
@@ -0,0 +1,108 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "GridGraph.h"
+
+class Map;
+
+/**
+ * Header of a binary map file (64 bytes, little endian, host layout).
+ *
+ * The occupancy section follows at occupancyOffset with exactly the GridGraph layout:
+ * rows of wordsPerRow 64-bit words, bit i of word w is column w*64 + i (1 = obstacle).
+ * Cost layers, if any, follow at costOffset: costLayers planes of cols*rows bytes, row-major.
+ */
+struct MapFileHeader {
+    char magic[4]; /// "RSMP"
+    std::uint32_t version; /// Format version (MapFile::VERSION)
+    std::uint32_t cols; /// Number of columns
+    std::uint32_t rows; /// Number of rows
+    std::uint32_t tileSize; /// Tile size in pixels, for the viewer
+    std::uint32_t wordsPerRow; /// 64-bit words per occupancy row
+    std::uint32_t costLayers; /// Number of byte cost layers
+    std::uint32_t reserved0;
+    std::uint64_t occupancyOffset; /// Byte offset of the occupancy words (multiple of 8)
+    std::uint64_t costOffset; /// Byte offset of the first cost layer (0 if none)
+    std::uint8_t reserved[16];
+};
+static_assert(sizeof(MapFileHeader) == 64, "MapFileHeader must be 64 bytes");
+
+/**
+ * Compact binary map file, opened through mmap.
+ *
+ * Opening a file maps it read-only and points a GridGraph at the occupancy section: nothing is
+ * parsed or copied and no Tile is created, so a 20000x20000 map (50 MB of bits) opens at once and
+ * pages are only read when a planner touches them. The first change to the grid copies it into
+ * memory (the file is never written through the mapping).
+ *
+ * Text and PGM images can be imported for authoring and then saved in the binary format.
+ */
+class MapFile {
+    private:
+        MapFileHeader header{}; /// Header of the open file
+        std::shared_ptr<const void> mapping; /// The mapped file (shared with the grids viewing it)
+        const std::uint8_t * base = nullptr; /// First byte of the mapped file
+        GridGraph occupancy; /// Views the occupancy section of the mapping
+
+    public:
+        static const std::uint32_t VERSION = 1;
+
+        /**
+         * Maps a binary map file.
+         * @param path File to open
+         * @return False (with a message on std::cerr) if the file cannot be mapped or is not a valid map file
+         */
+        bool open(const std::string& path);
+
+        bool isOpen() const {return base != nullptr;}
+        int getCols() const {return int(header.cols);}
+        int getRows() const {return int(header.rows);}
+        int getTileSize() const {return int(header.tileSize);}
+
+        /**
+         * Returns the occupancy of the open file. Copies of the grid share the mapping.
+         */
+        const GridGraph& getOccupancy() const {return occupancy;}
+
+        /**
+         * Creates a tile-less Map over the occupancy (see Map::fromOccupancy); the file stays mapped while the map lives.
+         * Cost layer 0, if any, becomes the map's tile costs (viewed in place, see CostLayer).
+         */
+        Map toMap() const;
+
+        int getCostLayerCount() const {return int(header.costLayers);}
+
+        /**
+         * Returns cost layer i (cols*rows bytes, row-major). Valid while this MapFile is open.
+         */
+        const std::uint8_t * getCostLayer(int i) const;
+
+        /**
+         * Writes a map in the binary format.
+         * @param path Destination file
+         * @param map Map to save (its occupancy, tile size and tile costs are stored)
+         * @param costLayers Optional cost layers, each of cols*rows bytes. If none are given, the tile costs
+         *                   of the map (if not uniform) are written as layer 0.
+         * @return False (with a message on std::cerr) if the file cannot be written
+         */
+        static bool save(const std::string& path, const Map& map,
+                         const std::vector<std::vector<std::uint8_t>>& costLayers = {});
+
+        /**
+         * Reads a text map: one line per row, '#', 'X', '@' or '1' is an obstacle, anything else is free.
+         * Short lines are padded with free tiles.
+         * @param path Text file
+         * @param out Receives the occupancy
+         */
+        static bool importText(const std::string& path, GridGraph& out);
+
+        /**
+         * Reads a PGM image (P2 or P5): one pixel per tile, pixels darker than threshold are obstacles.
+         * @param path Image file
+         * @param out Receives the occupancy
+         * @param threshold Gray level (0-255, scaled to the image max value) below which a pixel is an obstacle
+         */
+        static bool importPGM(const std::string& path, GridGraph& out, int threshold = 128);
+};
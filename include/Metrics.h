@@ -0,0 +1,93 @@
+#pragma once
+#include <atomic>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+
+/**
+ * Monotonic counter. add() is a relaxed atomic increment, so robots stepped in parallel can share it.
+ */
+class Counter {
+    private:
+        std::atomic<long> value{0};
+    public:
+        void add(long n = 1){value.fetch_add(n, std::memory_order_relaxed);}
+        long get() const {return value.load(std::memory_order_relaxed);}
+};
+
+/**
+ * Histogram of non-negative values with power-of-two buckets (bucket b counts values in [2^(b-1), 2^b)).
+ *
+ * Recording a value is a handful of relaxed atomic operations and never allocates.
+ * Percentiles are approximate: they return the upper bound of the bucket holding the rank.
+ */
+class Histogram {
+    public:
+        static const int BUCKETS = 64;
+
+    private:
+        std::atomic<long> buckets[BUCKETS] = {};
+        std::atomic<long> count{0};
+        std::atomic<double> sum{0.0};
+        std::atomic<double> minValue{std::numeric_limits<double>::infinity()};
+        std::atomic<double> maxValue{-std::numeric_limits<double>::infinity()};
+
+    public:
+        void record(double v);
+
+        long getCount() const {return count.load(std::memory_order_relaxed);}
+        double getSum() const {return sum.load(std::memory_order_relaxed);}
+        double getMin() const {return getCount() > 0 ? minValue.load(std::memory_order_relaxed) : 0.0;}
+        double getMax() const {return getCount() > 0 ? maxValue.load(std::memory_order_relaxed) : 0.0;}
+        double getMean() const {long n = getCount(); return n > 0 ? getSum() / n : 0.0;}
+
+        /**
+         * Approximate percentile.
+         * @param p Fraction in [0, 1] (0.5 = median)
+         */
+        double percentile(double p) const;
+};
+
+/**
+ * Named counters and histograms of a run, exported as CSV or JSON.
+ *
+ * Each metric is identified by a name and an optional label (e.g. "robot=3"). Looking a metric
+ * up takes a lock and may allocate, so hot paths look their metrics up once and keep the
+ * returned reference: it stays valid for the lifetime of the registry.
+ */
+class MetricsRegistry {
+    private:
+        typedef std::pair<std::string, std::string> Key; /// (name, label)
+        std::map<Key, std::unique_ptr<Counter>> counters;
+        std::map<Key, std::unique_ptr<Histogram>> histograms;
+        mutable std::mutex mutex;
+
+    public:
+        Counter& counter(const std::string& name, const std::string& label = "");
+        Histogram& histogram(const std::string& name, const std::string& label = "");
+
+        /**
+         * Writes one CSV row per metric: tick,type,name,label,count,sum,min,max,mean,p50,p90,p99.
+         * Counters only fill count. Rows of periodic dumps can be appended to the same file.
+         * @param tick Simulation tick of the snapshot
+         * @param header Also write the column names
+         */
+        void writeCsv(std::ostream& out, long tick, bool header = true) const;
+
+        /**
+         * Writes a snapshot as one JSON object on one line (periodic dumps form a JSON Lines file).
+         * @param tick Simulation tick of the snapshot
+         */
+        void writeJson(std::ostream& out, long tick) const;
+
+        /**
+         * Writes a snapshot to a file, as CSV if the path ends with ".csv", as JSON otherwise.
+         * @param append Append to the file (CSV without header) instead of replacing it
+         * @return False if the file cannot be written
+         */
+        bool dump(const std::string& path, long tick, bool append = false) const;
+};
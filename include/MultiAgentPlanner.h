@@ -0,0 +1,263 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "GridGraph.h"
+#include "SearchStats.h"
+#include "WorkerPool.h"
+
+/**
+ * How MultiAgentPlanner resolves the conflicts between the agents of a team.
+ */
+enum class MultiAgentMode {
+    Prioritized, /// Agents planned one after the other, each avoiding the reservations of the agents before it
+    ConflictBased /// Conflict-Based Search: optimal sum of costs, for small teams (falls back to Prioritized)
+};
+
+/**
+ * Converts a MultiAgentMode enum value to its string representation (also the name parsed by multiAgentModeFromString).
+ */
+inline const char* multiAgentModeToString(MultiAgentMode m) {
+    switch(m) {
+        case MultiAgentMode::Prioritized: return "prioritized";
+        case MultiAgentMode::ConflictBased: return "cbs";
+        default: return "unknown";
+    }
+}
+
+/**
+ * Parses a multi-agent mode name ("prioritized" or "cbs").
+ * @return False if the name is unknown
+ */
+inline bool multiAgentModeFromString(const std::string& name, MultiAgentMode& mode) {
+    for(MultiAgentMode m : {MultiAgentMode::Prioritized, MultiAgentMode::ConflictBased}){
+        if(name == multiAgentModeToString(m)){
+            mode = m;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Open-addressing hash map from 64-bit space-time keys to ints (linear probing, power of two capacity).
+ * Keys must not be ~0. clear() keeps the capacity, so a table reused between searches stops allocating.
+ */
+class SpaceTimeHash {
+    private:
+        static constexpr std::uint64_t EMPTY = ~std::uint64_t(0);
+        std::vector<std::uint64_t> keys;
+        std::vector<int> values;
+        std::size_t count = 0;
+        std::size_t mask = 0;
+
+        std::size_t slot(std::uint64_t key) const {return std::size_t((key * 0x9E3779B97F4A7C15ull) >> 20) & mask;}
+        void grow();
+
+    public:
+        void clear();
+
+        /// Value of key, or 'missing' if absent
+        int find(std::uint64_t key, int missing = -1) const {
+            if(count == 0)
+                return missing;
+            for(std::size_t i = slot(key);; i = (i + 1) & mask){
+                if(keys[i] == key)
+                    return values[i];
+                if(keys[i] == EMPTY)
+                    return missing;
+            }
+        }
+
+        /// Reference to the value of key, inserted with 'initial' if absent
+        int& at(std::uint64_t key, int initial);
+
+        std::size_t size() const {return count;}
+        std::size_t getMemoryBytes() const {return keys.capacity() * sizeof(std::uint64_t) + values.capacity() * sizeof(int);}
+};
+
+/**
+ * Space-time reservations on the tile grid: which agent holds a tile at a time step, which moves are
+ * forbidden at a time step, and which tiles are held for good from some time on (agents parked on their goal).
+ *
+ * Time is counted in steps: at each step an agent moves to a 4-neighbor or waits. A move from -> to
+ * made between t and t+1 is allowed if 'to' is not held at t+1 and not parked since t+1 or before, and
+ * if the move itself is not forbidden (a swap with an agent doing to -> from, or a CBS edge constraint).
+ */
+class ReservationTable {
+    private:
+        SpaceTimeHash vertices; /// (tile, t) -> agent
+        SpaceTimeHash moves; /// (from, direction, t) -> agent whose reservation forbids the move
+        SpaceTimeHash parked; /// tile -> time from which it is held for good
+        SpaceTimeHash lastHeld; /// tile -> last time it is held (for the goal test)
+
+        int cols = 0;
+
+        static std::uint64_t vertexKey(int tile, int t){return (std::uint64_t(t) << 34) | std::uint64_t(tile);}
+        std::uint64_t moveKey(int from, int to, int t) const;
+
+    public:
+        /// Sizes the table for a grid and removes every reservation
+        void reset(int gridCols);
+        void clear();
+
+        /// Agent holding tile at time t (-1 if free); parked agents are not reported
+        int holder(int tile, int t) const {return vertices.find(vertexKey(tile, t));}
+
+        /// Holds tile at time t for agent
+        void reserve(int tile, int t, int agent);
+
+        /// Forbids the move from -> to between t and t+1 (a wait if from == to)
+        void forbidMove(int from, int to, int t, int agent);
+
+        /// Holds tile from time t on for agent
+        void park(int tile, int t, int agent);
+
+        /// Time from which tile is held for good (INT_MAX if never)
+        int parkedSince(int tile) const;
+
+        /// Last time tile is held, parking excluded (-1 if never): an agent can only stop there after it
+        int getLastHeld(int tile) const {return lastHeld.find(std::uint64_t(tile));}
+
+        /**
+         * True if an agent can make the move from -> to between t and t+1 (see the class comment).
+         */
+        bool canMove(int from, int to, int t) const;
+
+        /**
+         * Reserves a timed path for agent: tile path[t] at time t, the reverse of each move
+         * (so no other agent swaps with it) and the last tile from the last step on.
+         */
+        void reservePath(const std::vector<int>& path, int agent);
+
+        /// True if path can be followed without breaking any reservation (goal parking included)
+        bool admits(const std::vector<int>& path) const;
+
+        std::size_t size() const {return vertices.size() + moves.size() + parked.size();}
+};
+
+/**
+ * Work and result of one MultiAgentPlanner::plan call.
+ */
+struct MultiAgentStats {
+    int agents = 0;
+    int solved = 0; /// Agents for which a path to their goal was found
+    long sumOfCosts = 0; /// Steps (moves and waits) of the solved agents until they stay on their goal
+    int makespan = 0; /// Steps until the last agent stays on its goal
+    SearchStats lowLevel; /// Space-time A* work, over every search
+    int searches = 0; /// Space-time A* searches (discarded speculative ones included)
+    int rounds = 0; /// Prioritized: parallel rounds; ConflictBased: constraint tree nodes expanded
+    bool fellBack = false; /// ConflictBased gave up (team too large or node limit) and used Prioritized
+    double milliseconds = 0.0; /// Wall time of the call, heuristics included
+};
+
+/**
+ * Cooperative path planner for a team of agents sharing the true map.
+ *
+ * Paths are timed: path[t] is the tile of the agent at step t, a repeated tile is a wait, and the
+ * agent stays on the last tile (its goal) afterwards. Planned paths have no vertex conflict (two
+ * agents on one tile at the same step), no swap conflict and never cross a parked agent. An agent
+ * without a path stays on its start, and the others plan around it.
+ *
+ * The low-level search is space-time A* over (tile, step) states, guided by the exact distance to
+ * the goal on the static grid (one backward BFS per agent, computed in parallel and kept while the
+ * goal does not change). On very large maps the Manhattan distance is used instead.
+ *
+ * Prioritized mode plans the agents in priority order (longest first) against a ReservationTable.
+ * To use several cores, the next few pending agents are planned in parallel against the same
+ * reservations; they are then committed in priority order, and an agent whose path conflicts with
+ * one committed earlier in the round is planned again in the next round. The first pending agent
+ * is always committed or given up, and every committed path is a shortest one given the reservations
+ * of the agents before it, as in the sequential order. An agent given up is parked on its start from
+ * step 0, and the committed agents whose path crosses that tile go back to the pending ones.
+ * Rounds have a fixed size (PRIORITIZED_BATCH), so the result does not depend on the number of threads.
+ *
+ * ConflictBased mode runs Conflict-Based Search (Sharon et al.): a best-first search over sets of
+ * constraints, each node replanning one agent; the two children of a node are replanned in parallel.
+ * It is optimal but exponential in the number of conflicts, so it is used for teams of up to
+ * CBS_MAX_AGENTS agents and abandoned after CBS_MAX_NODES nodes (the team is then planned with Prioritized).
+ */
+class MultiAgentPlanner {
+    public:
+        static constexpr int CBS_MAX_AGENTS = 16;
+        static constexpr int CBS_MAX_NODES = 2000;
+        /// Above this many (tiles x agents) the heuristic is Manhattan instead of a BFS distance per agent
+        static constexpr long MAX_HEURISTIC_CELLS = 1L << 24;
+        /// Pending agents planned in parallel in one prioritized round
+        static constexpr int PRIORITIZED_BATCH = 16;
+        /// Default budget of a low-level search, per step of its time bound (a search over the budget fails)
+        static constexpr int EXPANSIONS_PER_STEP = 32;
+
+    private:
+        const GridGraph * grid = nullptr;
+        WorkerPool * pool = nullptr; /// nullptr: everything runs on the calling thread
+        int cols = 0;
+        int rows = 0;
+
+        std::vector<int> starts;
+        std::vector<int> goals;
+        std::vector<std::vector<int>> distances; /// BFS distance to the goal of each agent (empty: Manhattan)
+        std::vector<int> distanceGoals; /// Goal each distance field was computed for
+        std::vector<std::vector<int>> paths;
+        std::vector<char> reached; /// The agent's path was found and ends on its goal
+        ReservationTable reservations;
+        MultiAgentStats lastStats;
+        int maxExpansions = 0; /// Per low-level search (0: EXPANSIONS_PER_STEP per step of the time bound)
+
+        struct Search; /// Scratch buffers of one low-level search (one per thread)
+        std::vector<std::unique_ptr<Search>> searches;
+
+        int heuristic(int agent, int tile) const;
+        void computeDistances();
+        bool findPath(int agent, const ReservationTable& table, Search& s, std::vector<int>& path, SearchStats& stats) const;
+
+        /**
+         * Calls f(i, scratch) for every i in [0, n), on the pool if there is one.
+         * Each call gets the scratch buffers of the thread running it.
+         */
+        void forEachAgent(int n, const std::function<void(int, Search&)>& f);
+
+        void planPrioritized();
+        bool planConflictBased();
+
+    public:
+        MultiAgentPlanner();
+        /**
+         * @param g Static obstacles of the map (the true map). It must outlive the planner.
+         * @param workers Pool running the low-level searches in parallel (nullptr for none). It must outlive the planner.
+         */
+        MultiAgentPlanner(const GridGraph * g, WorkerPool * workers);
+        ~MultiAgentPlanner();
+
+        MultiAgentPlanner(const MultiAgentPlanner&) = delete;
+        MultiAgentPlanner& operator=(const MultiAgentPlanner&) = delete;
+
+        /**
+         * Sets the map and the pool. Call it again when the obstacles change: the distance fields are dropped.
+         */
+        void setGrid(const GridGraph * g, WorkerPool * workers);
+
+        /// Limits the states expanded by one low-level search (0 restores the default budget)
+        void setMaxExpansions(int n){maxExpansions = n;}
+
+        /**
+         * Plans the team. Agent i goes from startTiles[i] to goalTiles[i]; starts must be distinct free tiles,
+         * and so must goals. The distance fields of the agents whose goal did not change are reused.
+         * @return The timed path of each agent (getPaths()); an agent without a path gets {start} and is not
+         *         counted as solved, even if its start is its goal
+         */
+        const std::vector<std::vector<int>>& plan(const std::vector<int>& startTiles, const std::vector<int>& goalTiles,
+                                                  MultiAgentMode mode = MultiAgentMode::Prioritized);
+
+        const std::vector<std::vector<int>>& getPaths() const {return paths;}
+        const MultiAgentStats& getLastStats() const {return lastStats;}
+
+        /**
+         * Counts the conflicts between timed paths: two agents on one tile at the same step (an agent
+         * stays on its last tile) or swapping tiles between two steps. Used to check a plan, or to show
+         * what independent shortest paths would run into.
+         */
+        static int countConflicts(const std::vector<std::vector<int>>& timedPaths);
+};
@@ -0,0 +1,90 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+/**
+ * Per-tile planner state (distances, parents, flags) over a cols x rows grid.
+ *
+ * Dense layout: one std::vector, as the planners always used.
+ * Chunked layout (for chunked GridGraphs): 64x64-tile chunks allocated on first write; reading a tile
+ * of an unallocated chunk returns the fill value. A search then only pays memory for the chunks
+ * it reaches, not for the whole world.
+ *
+ * The non-const operator[] allocates the chunk of the tile: read through a const reference
+ * (or get()) where a read must not allocate.
+ */
+template<typename T>
+class NodeArray {
+    private:
+        static const int CHUNK = 64; /// Chunk side in tiles
+
+        bool chunked = false;
+        int cols = 0;
+        int chunkCols = 0; /// Chunks per row of chunks
+        T fill = T();
+        std::vector<T> values; /// Dense layout
+        std::vector<std::unique_ptr<T[]>> chunks; /// Chunked layout, nullptr until written
+
+        std::size_t chunkIndex(int id, int& offset) const {
+            int r = id / cols;
+            int c = id - r * cols;
+            offset = (r & (CHUNK - 1)) * CHUNK + (c & (CHUNK - 1));
+            return std::size_t(r / CHUNK) * chunkCols + c / CHUNK;
+        }
+
+    public:
+        /**
+         * Sizes the array for a grid and sets every value to 'value' (chunked: frees every chunk).
+         */
+        void assign(int gridCols, int gridRows, T value, bool chunkedLayout){
+            chunked = chunkedLayout;
+            cols = gridCols;
+            fill = value;
+            if(chunked){
+                values.clear();
+                values.shrink_to_fit();
+                chunkCols = (gridCols + CHUNK - 1) / CHUNK;
+                chunks.clear();
+                chunks.resize(std::size_t(chunkCols) * ((gridRows + CHUNK - 1) / CHUNK));
+            }
+            else{
+                chunks.clear();
+                values.assign(std::size_t(gridCols) * gridRows, value);
+            }
+        }
+
+        T get(int id) const {
+            if(!chunked)
+                return values[id];
+            int offset;
+            const std::unique_ptr<T[]>& chunk = chunks[chunkIndex(id, offset)];
+            return chunk ? chunk[offset] : fill;
+        }
+
+        T operator[](int id) const {return get(id);}
+
+        T& operator[](int id){
+            if(!chunked)
+                return values[id];
+            int offset;
+            std::unique_ptr<T[]>& chunk = chunks[chunkIndex(id, offset)];
+            if(!chunk){
+                chunk.reset(new T[CHUNK * CHUNK]);
+                for(int i = 0; i < CHUNK * CHUNK; i++)
+                    chunk[i] = fill;
+            }
+            return chunk[offset];
+        }
+
+        bool isChunked() const {return chunked;}
+
+        /// Heap memory used by the values
+        std::size_t getMemoryBytes() const {
+            std::size_t bytes = values.capacity() * sizeof(T) + chunks.capacity() * sizeof(chunks[0]);
+            for(const auto& chunk : chunks)
+                if(chunk)
+                    bytes += CHUNK * CHUNK * sizeof(T);
+            return bytes;
+        }
+};
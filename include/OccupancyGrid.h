@@ -0,0 +1,124 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "GridGraph.h"
+#include "NodeArray.h"
+
+/**
+ * How a robot turns sensor readings into its belief map.
+ */
+enum class BeliefModel {
+    Binary, /// A tile is marked as an obstacle the first time a sensor hits it, for good
+    LogOdds /// Readings are accumulated in an OccupancyGrid; the belief map is its thresholded view
+};
+
+/**
+ * Converts a BeliefModel enum value to its string representation (also the name parsed by beliefModelFromString).
+ */
+inline const char* beliefModelToString(BeliefModel m) {
+    switch(m) {
+        case BeliefModel::Binary: return "binary";
+        case BeliefModel::LogOdds: return "logodds";
+        default: return "unknown";
+    }
+}
+
+/**
+ * Parses a belief model name ("binary" or "logodds").
+ * @return False if the name is unknown
+ */
+inline bool beliefModelFromString(const std::string& name, BeliefModel& model) {
+    for(BeliefModel m : {BeliefModel::Binary, BeliefModel::LogOdds}){
+        if(name == beliefModelToString(m)){
+            model = m;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Sensor model of an OccupancyGrid, in log-odds (ln(p / (1 - p))).
+ */
+struct OccupancyParams {
+    float hit = 0.85f; /// Added when a ray ends on the tile (p = 0.7)
+    float miss = -0.4f; /// Added when a ray crosses the tile (p = 0.4)
+    float min = -2.0f; /// Clamping bounds: evidence saturates, so a tile can always change state again
+    float max = 3.5f;
+    float blockAbove = 1.5f; /// A free tile becomes blocked at or above this value (two hits in a row)
+    float clearBelow = 0.5f; /// A blocked tile becomes free at or below this value
+};
+
+/**
+ * Probabilistic occupancy of a robot's belief map: one log-odds value per tile, 0 (p = 0.5) for an unseen tile.
+ *
+ * Readings are queued with addHit/addMiss and applied together by applyBatch, once per scan. The batch is
+ * sorted and merged (a tile gets at most one hit or miss per scan, however many rays cross it), then the
+ * log-odds are gathered into contiguous arrays, updated by a branch-free loop the compiler vectorizes
+ * (add, clamp, threshold), and scattered back. Tiles confirmed by a contact sensor (setOccupied) are pinned
+ * blocked: their readings are dropped from the batch.
+ *
+ * The planners never read the log-odds: they read the belief GridGraph, which applyBatch keeps as the
+ * thresholded view. The two thresholds form a hysteresis band, so a tile near 0.5 does not toggle
+ * (and trigger a replan) on every reading.
+ *
+ * Storage is a NodeArray: chunked on a chunked belief grid, so only the sensed part of a large world
+ * costs memory.
+ */
+class OccupancyGrid {
+    private:
+        int cols = 0;
+        int rows = 0;
+        OccupancyParams params;
+        NodeArray<float> logOdds;
+        NodeArray<std::uint8_t> pinned; /// 1 for a tile set by setOccupied: the batch updates skip it
+        long updates = 0; /// Tile updates applied since reset
+
+        /// Pending readings (tile * 2 + 1 for a hit, tile * 2 for a miss: sorting integers is the cheapest merge),
+        /// then the merged batch as structure of arrays
+        std::vector<std::int64_t> pending;
+        std::vector<int> batchTiles;
+        std::vector<float> batchDeltas;
+        std::vector<float> batchValues;
+        std::vector<std::int32_t> batchBlocked; /// State of each tile in the view before the update, then its flip flag (32-bit: same lanes as the floats)
+
+    public:
+        /**
+         * Sizes the grid and forgets every reading.
+         * @param chunked Chunked storage (use the layout of the belief GridGraph)
+         */
+        void reset(int gridCols, int gridRows, bool chunked);
+
+        void setParams(const OccupancyParams& p){params = p;}
+        const OccupancyParams& getParams() const {return params;}
+
+        /// Queues a ray ending on the tile
+        void addHit(int tile){pending.push_back(std::int64_t(tile) * 2 + 1);}
+        /// Queues a ray crossing the tile
+        void addMiss(int tile){pending.push_back(std::int64_t(tile) * 2);}
+        bool hasPending() const {return !pending.empty();}
+
+        /**
+         * Applies the queued readings.
+         * @param view Thresholded view (belief grid). It is only read: the caller applies the flips,
+         *             since the planners must be told about each one.
+         * @param flipped Receives the tiles whose thresholded state changed (cleared first)
+         */
+        void applyBatch(const GridGraph& view, std::vector<int>& flipped);
+
+        /**
+         * Sets a tile to the maximum and pins it there: contact sensors are taken as certain, so later
+         * range readings of the tile (noisy misses included) are dropped by applyBatch.
+         */
+        void setOccupied(int tile){logOdds[tile] = params.max; pinned[tile] = 1;}
+        bool isPinned(int tile) const {return pinned.get(tile) != 0;}
+
+        float getLogOdds(int tile) const {return logOdds.get(tile);}
+        /// Probability of the tile being an obstacle
+        float getProbability(int tile) const;
+
+        /// Tile updates applied since reset (after merging)
+        long getUpdates() const {return updates;}
+        std::size_t getMemoryBytes() const {return logOdds.getMemoryBytes() + pinned.getMemoryBytes();}
+};
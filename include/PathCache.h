@@ -0,0 +1,68 @@
+#pragma once
+#include <cstddef>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Least-recently-used cache of planned paths, keyed by (start, goal, map version).
+ *
+ * The map version changes whenever the occupancy changes, so a path planned on an older
+ * map is never returned: it simply misses and ages out of the cache.
+ */
+class PathCache {
+    private:
+        struct Key {
+            int start;
+            int goal;
+            unsigned long version;
+            bool operator==(const Key& o) const {return start == o.start && goal == o.goal && version == o.version;}
+        };
+        struct KeyHash {
+            std::size_t operator()(const Key& k) const {
+                std::size_t h = std::size_t(k.start) * 0x9E3779B97F4A7C15ull;
+                h ^= std::size_t(k.goal) + 0x7F4A7C15ull + (h << 6) + (h >> 2);
+                h ^= std::size_t(k.version) + 0x7F4A7C15ull + (h << 6) + (h >> 2);
+                return h;
+            }
+        };
+        typedef std::pair<Key, std::vector<int>> Entry;
+
+        std::size_t capacity = 0; /// Maximum number of paths (0 disables the cache)
+        std::list<Entry> entries; /// Most recently used first
+        std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index;
+        long hits = 0;
+        long misses = 0;
+
+        /// Copies everything but the entries from o and indexes the entries
+        void copyState(const PathCache& o);
+
+    public:
+        explicit PathCache(std::size_t maxPaths = 0) : capacity(maxPaths) {}
+        /// A copy indexes its own entries (the source's index points into the source's list)
+        PathCache(const PathCache& o);
+        PathCache(PathCache&&) = default;
+        PathCache& operator=(const PathCache& o);
+        PathCache& operator=(PathCache&& o) noexcept;
+
+        /// Changes the capacity, dropping the least recently used paths if needed (0 disables the cache)
+        void setCapacity(std::size_t maxPaths);
+        std::size_t getCapacity() const {return capacity;}
+        bool isEnabled() const {return capacity > 0;}
+
+        /**
+         * Looks up a path.
+         * @return Pointer to the cached path (valid until the next put), or nullptr on a miss
+         */
+        const std::vector<int> * get(int start, int goal, unsigned long version);
+
+        /**
+         * Stores a path, evicting the least recently used one when the cache is full.
+         */
+        void put(int start, int goal, unsigned long version, const std::vector<int>& path);
+
+        void clear(){entries.clear(); index.clear();}
+        std::size_t size() const {return entries.size();}
+        long getHits() const {return hits;}
+        long getMisses() const {return misses;}
+};
@@ -0,0 +1,120 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "BeliefGrid.h"
+#include "SearchStats.h"
+
+/**
+ * Path search handed to a PlanWorker. The worker keeps its own copy of the belief map: a request only
+ * carries the tiles whose belief changed since the previous one, with their new state.
+ */
+struct PlanRequest {
+    long generation = 0; /// Set by PlanWorker::request
+    std::vector<std::pair<int, CellState>> changedTiles; /// Applied in order (a tile may appear more than once)
+    int start = -1;
+    int goal = -1;
+};
+
+/**
+ * Path found by a PlanWorker for one request.
+ */
+struct PlanResult {
+    long generation = 0; /// Request the path answers (0: none yet)
+    std::vector<int> path; /// From the request start to its goal ({goal} if there is none)
+    SearchStats stats;
+    double microseconds = 0.0; /// Wall time of the search on the worker
+    std::string log; /// Planner messages of a verbose robot, printed by the robot when it takes the path
+};
+
+/**
+ * Single-writer single-reader lock-free buffer of PlanResults: a double buffer (the slot being read and
+ * the latest published one) plus the slot being written, swapped through one atomic index.
+ * Neither side ever waits for the other, and the reader always gets the latest complete result.
+ */
+class PathBuffer {
+    private:
+        static const int FRESH = 4; /// Set in 'latest' when the slot it names was published after the last consume
+        PlanResult slots[3];
+        std::atomic<int> latest{2}; /// Slot published last (plus FRESH)
+        int back = 0; /// Slot owned by the writer
+        int front = 1; /// Slot owned by the reader
+
+    public:
+        /// Writer: slot to fill before publish()
+        PlanResult& writeSlot(){return slots[back];}
+        /// Writer: makes the filled slot the latest one
+        void publish(){back = latest.exchange(back | FRESH) & 3;}
+
+        /**
+         * Reader: takes the latest published result, if there is one since the last call.
+         * @return nullptr if nothing new was published. The result stays valid until the next call.
+         */
+        const PlanResult * consume(){
+            if(!(latest.load(std::memory_order_relaxed) & FRESH))
+                return nullptr;
+            front = latest.exchange(front) & 3;
+            return &slots[front];
+        }
+};
+
+/**
+ * Background thread running the path searches of one robot, so a long search never stalls the simulation step.
+ *
+ * Requests go through a one-slot mailbox: a request posted while another one is still queued replaces it
+ * (its changed tiles are kept), and a search that finishes after a newer request was posted is not
+ * published. Only the answer to the latest request ever reaches the robot, which polls it once per tick.
+ */
+class PlanWorker {
+    public:
+        /// Runs the search of a request on the worker thread and fills the result (path, stats)
+        using Job = std::function<void(PlanRequest&, PlanResult&)>;
+
+    private:
+        Job job;
+        std::mutex mutex;
+        std::condition_variable wake;
+        PlanRequest pending; /// Latest request not taken by the worker yet
+        bool hasPending = false;
+        bool stopping = false;
+        std::atomic<long> latest{0}; /// Generation of the latest request
+        std::atomic<long> cancelled{0}; /// Requests replaced while queued or finished after a newer one
+        std::condition_variable done; /// Signalled when a result is published
+        long publishedGeneration = 0; /// Generation of the last published result (guarded by mutex)
+        PathBuffer results;
+        std::thread thread; /// Started last, stopped first
+
+        void workerLoop();
+
+    public:
+        explicit PlanWorker(Job j);
+        ~PlanWorker();
+
+        PlanWorker(const PlanWorker&) = delete;
+        PlanWorker& operator=(const PlanWorker&) = delete;
+
+        /**
+         * Posts a request, cancelling the one still queued if any.
+         * @return The generation given to the request
+         */
+        long request(PlanRequest&& r);
+
+        /**
+         * Latest published result, if one was published since the last call (check its generation against request()).
+         */
+        const PlanResult * poll(){return results.consume();}
+
+        /**
+         * Blocks until the result of a request is published (it must be the latest request: older ones may be dropped).
+         * The result is then returned by the next poll().
+         */
+        void wait(long generation);
+
+        /// Requests dropped before their result reached the robot
+        long getCancelled() const {return cancelled.load();}
+};
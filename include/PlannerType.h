@@ -0,0 +1,36 @@
+#ifndef PLANNER_TYPE_H
+#define PLANNER_TYPE_H
+
+/**
+ * Enumeration of the path planners a Robot can use to (re)compute its path.
+ */
+enum class PlannerType {
+    Dijkstra, /// Full Dijkstra search on the robot map at every replan
+    AStar, /// A* search (Manhattan heuristic) on the robot map at every replan
+    JumpPoint, /// Jump Point Search on the robot map at every replan
+    DStarLite, /// Incremental D* Lite: keeps its search state and repairs it when a tile changes
+    Hierarchical, /// HPA*: abstract graph over clusters, rebuilt only where a tile changes
+    Dial, /// Dijkstra on a bucket queue over the integer tile costs, at every replan
+    Landmarks /// A* with the landmark (ALT) heuristic, tables built on the robot map (see Map::preprocessLandmarks)
+};
+
+/**
+ * Converts a PlannerType enum value to its corresponding string representation.
+ *
+ * @param p The planner to convert.
+ * @return const char* String name of the planner.
+ */
+inline const char* plannerTypeToString(PlannerType p) {
+    switch(p) {
+        case PlannerType::Dijkstra: return "Dijkstra";
+        case PlannerType::AStar: return "AStar";
+        case PlannerType::JumpPoint: return "JumpPoint";
+        case PlannerType::DStarLite: return "DStarLite";
+        case PlannerType::Hierarchical: return "Hierarchical";
+        case PlannerType::Dial: return "Dial";
+        case PlannerType::Landmarks: return "Landmarks";
+        default: return "Unknown";
+    }
+}
+
+#endif
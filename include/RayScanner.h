@@ -0,0 +1,71 @@
+#pragma once
+#include <random>
+#include <vector>
+#include "GridGraph.h"
+
+/**
+ * Range sensor casting rays from a tile over the bit-packed occupancy of a map.
+ *
+ * The occupancy is read in place (const GridGraph), nothing is copied. Rays are spread evenly
+ * around the robot and stop on the first obstacle or after 'range' tiles.
+ * Horizontal rays test up to 64 tiles with one word operation; vertical rays read one bit per row;
+ * the other rays step through the grid with a DDA (Amanatides & Woo).
+ *
+ * An optional noise model (setNoise) makes readings wrong with a fixed probability: a free tile can
+ * return a hit (the ray stops there) and an obstacle can be missed (the ray goes through it). Noisy
+ * scans step every ray with the DDA, since each tile probed draws from the scanner's random stream.
+ */
+class RayScanner {
+    private:
+        int rayCount = 0; /// Number of rays
+        int range = 0; /// Maximum distance, in tiles
+        std::vector<float> dirX; /// Unit direction of each ray (x = columns)
+        std::vector<float> dirY; /// Unit direction of each ray (y = rows)
+
+        int castHorizontal(const GridGraph& grid, int c, int r, int dx) const;
+        int castVertical(const GridGraph& grid, int c, int r, int dy) const;
+        int castDDA(const GridGraph& grid, int c, int r, float dx, float dy) const;
+        int castTrace(const GridGraph& grid, int c, int r, float dx, float dy, std::vector<int>* crossed);
+
+        double falseHitRate = 0.0; /// Probability for a probed free tile to return a hit
+        double missedHitRate = 0.0; /// Probability for an obstacle to be missed
+        std::mt19937 rng; /// Noise stream (seeded by setNoise)
+        std::uniform_real_distribution<double> uniform{0.0, 1.0};
+
+    public:
+        /**
+         * @param rays Number of rays (a multiple of 4 includes the 4 axis directions)
+         * @param maxRange Maximum distance in tiles (0 disables the scanner)
+         */
+        RayScanner(int rays = 0, int maxRange = 0){configure(rays, maxRange);}
+
+        void configure(int rays, int maxRange);
+
+        int getRayCount() const {return rayCount;}
+        int getRange() const {return range;}
+        bool isEnabled() const {return rayCount > 0 && range > 0;}
+
+        /**
+         * Makes the readings noisy. Rates of 0 restore exact readings.
+         * @param falseHit Probability for each free tile a ray probes to be reported as a hit
+         * @param missedHit Probability for each obstacle a ray reaches to be missed
+         * @param seed Seed of the noise stream (give each robot its own)
+         */
+        void setNoise(double falseHit, double missedHit, unsigned seed);
+        bool isNoisy() const {return falseHitRate > 0.0 || missedHitRate > 0.0;}
+
+        /**
+         * Casts every ray from the center of the origin tile.
+         * @param grid Occupancy of the true map
+         * @param origin Tile the rays start from
+         * @param hits Receives the index of each obstacle hit (cleared first; a tile hit by two rays appears twice)
+         */
+        void scan(const GridGraph& grid, int origin, std::vector<int>& hits);
+
+        /**
+         * Casts every ray like scan and also reports the tiles the rays cross before stopping
+         * (free space, for the misses of an OccupancyGrid).
+         * @param crossed Receives the tiles crossed, ray after ray (cleared first; the origin is not included)
+         */
+        void traceRays(const GridGraph& grid, int origin, std::vector<int>& crossed, std::vector<int>& hits);
+};
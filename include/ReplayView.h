@@ -0,0 +1,17 @@
+#pragma once
+#include <string>
+
+/**
+ * Replays a trace recorded by TraceRecorder (e.g. RobotSimHeadless --trace) in two windows:
+ * the true map with every robot, and the belief map of one robot.
+ *
+ * Poses, paths and discoveries are decoded from the trace: neither Robot::update nor any planner
+ * runs, so the replay can play at any speed and seek to any tick.
+ *
+ * Keys: Space pause/resume, '+'/'-' speed, Left/Right seek 5 s back/forward, ','/'.' one tick
+ * back/forward, Home/End first/last tick, 0-9 seek to 0%-90%, 'R' show the next robot's belief map.
+ *
+ * @param path Trace file
+ * @return Process exit code
+ */
+int runReplay(const std::string& path);
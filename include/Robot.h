@@ -1,56 +1,314 @@
 #pragma once
-#include <SFML/Graphics.hpp>
 #include "Map.h"
 #include "Sensor.h"
 #include "Direction.h"
+#include "DStarLite.h"
+#include "HierarchicalPlanner.h"
+#include "JumpPointSearch.h"
+#include "PlannerType.h"
+#include "RayScanner.h"
+#include "OccupancyGrid.h"
+#include "Metrics.h"
+#include "PlanWorker.h"
+#include "RobotStates.h"
+#include <memory>
+#include <utility>
 
 /**
  * Represents a robot that can navigate a map using sensors and Dijkstra's algorithm.
  * 
  * The robot maintains a local copy of the map without obstacles (robotMap) and updates it based on sensor feedback.
+ * robotMap is a tile-less belief map (see Map::cloneBelief): 2 bits per tile, only where the robot wrote something,
+ * and pages shared with the other robots copying the same prior (dense bits on a map within one page).
  * It follows a path, recalculating if an obstacle is detected during motion.
+ * The robot only owns its simulation state (pose, path, sensors): the SFML view draws it from getPosition()/getRadius().
  */
 class Robot{
     private: 
         int r=25; /// Radius of the robot shape
         int x, y; /// Current coordinates
-        sf::CircleShape shape; ///SFML circle representing the robot
-        float speed=0.5f;
+        RobotStates ownStates; /// Slot of a robot running alone
+        RobotStates * states; /// Pose, speed, path step and ticks (see RobotStates): ownStates or a fleet's store
+        int slot; /// Index of the robot in states
+
+        /// Fields of the robot in states
+        float& posX(){return states->posX[slot];} /// Top-left corner of the robot's bounding box, in pixels
+        float& posY(){return states->posY[slot];}
+        float speed() const {return states->speed[slot];} /// Distance covered by one update (one fixed simulation step), in pixels
+        int& currentStep(){return states->step[slot];}
+        long& ticks(){return states->ticks[slot];}
         
         Map * map; /// Pointer to the real map (with obstacles)
 
-        /// Map replica used by the robot (same structure but initially no obstacles)
+        /// Belief map used by the robot (same structure, every tile unknown at first)
         Map robotMap; 
 
         int currentTile = -1;
         std::vector<int> pathToFollow; 
-        int currentStep = 0;
         int startTile = -1; 
         int endTile = -1;
         bool pathComputed = false; 
         bool robotPlaced = false; 
-        sf::RenderWindow * win; 
         bool canRunAlgo = false;
+        bool goalReached = false;
 
         std::vector<Sensor> sensors; /// Sensors for obstacle detection (Up, Down, Left, Right)
         std::vector<bool> detected; /// Obstacle detection flags from sensors
+        RayScanner scanner; /// Optional range scanner (disabled by default)
+        std::vector<int> scanHits; /// Obstacles hit by the last scan (buffer reused between scans)
+        int lastScanTile = -1; /// Tile of the last range scan
+        BeliefModel beliefModel = BeliefModel::Binary; /// How sensor readings update robotMap
+        OccupancyGrid occupancy; /// Log-odds behind robotMap (BeliefModel::LogOdds only)
+        std::vector<int> scanCrossed; /// Free tiles crossed by the rays of the last scan (buffer reused between scans)
+        std::vector<int> flippedTiles; /// Tiles whose belief changed in the last scan (buffer reused between scans)
+        bool scanCleared = false; /// The last scan turned at least one belief obstacle back into free space
+        bool waitingForPath = false; /// No path was found, the robot scans again before giving up (BeliefModel::LogOdds)
+        int waitScans = 0; /// Scans done while waiting for a path
+        long clearedTiles = 0; /// Belief obstacles cleared by later readings
         bool nextMoveIsValide = true;
         bool needToComputePath = true; 
+        bool followingPlan = false; /// Following a timed path from a team planner (see followPlan)
+        int waitedTicks = 0; /// Ticks spent on the current wait step of a timed path
+
+        PlannerType plannerType = PlannerType::DStarLite; /// Planner used to (re)compute the path
+        DStarLite incrementalPlanner; /// Search state kept between replans (PlannerType::DStarLite)
+        JumpPointSearch jumpPointPlanner; /// Scratch buffers reused between replans (PlannerType::JumpPoint)
+        HierarchicalPlanner hierarchicalPlanner; /// Cluster abstraction kept between replans (PlannerType::Hierarchical)
+        unsigned long landmarkVersion = 0; /// Version of the planned map when its landmarks were built (PlannerType::Landmarks)
+        SearchStats plannerTotals; /// Work done by all the searches of this robot
+        int replans = 0; /// Number of path computations
+
+        Map planMap; /// Copy of robotMap (occupancy and costs) searched by the planners on the worker thread (async planning only)
+        std::vector<int> changedTiles; /// Belief changes not sent to the worker yet (async planning only)
+        long planGeneration = 0; /// Generation of the last request posted to the worker
+        bool planPending = false; /// Waiting for the answer to planGeneration
+
+        bool logDiscoveries = false; /// Keep the obstacles discovered since the last clearNewDiscoveries (for TraceRecorder)
+        std::vector<std::pair<int, bool>> newDiscoveries; /// Tiles marked as obstacles (true) or cleared (false) on robotMap, in order
+        Counter * replanCounter = nullptr; /// Metrics of the robot (all null until setMetrics)
+        Counter * sensorHitCounter = nullptr;
+        Histogram * expandedHistogram = nullptr;
+        Histogram * pushedHistogram = nullptr;
+        Histogram * latencyHistogram = nullptr;
+        Histogram * pathLengthHistogram = nullptr;
+        Histogram * ticksToGoalHistogram = nullptr;
+
+        bool verbose = true; /// Log planning and sensing events on std::cout
+        bool highlightPath = true; /// Color the current path on the true map (disabled when the map is shared by a fleet)
+
+        std::unique_ptr<PlanWorker> planWorker; /// Thread running the searches (async planning only); declared last, so stopped first
+
+        /**
+         * Full update: sensing, planning and path following (update() without the plain-move shortcut).
+         */
+        void fullUpdate();
+
+        /**
+         * Tells states whether the next tick is a plain move toward the next tile of the path (see RobotStates),
+         * and where to. Called after each full update.
+         */
+        void refreshCruise();
+
+        /// Makes the next tick a full update (after a change made from outside update())
+        void stopCruise(){states->flags[slot] &= ~RobotStates::CRUISING;}
+
+        /**
+         * Computes the path from the current tile to the end tile on robotMap with the selected planner.
+         */
+        std::vector<int> computePath();
+
+        /**
+         * Runs the selected planner on 'on' from tile 'from' to tile 'to'. The incremental planners must be bound to 'on'.
+         * It only touches 'on', the planners and 'log', so with async planning it runs on the worker thread.
+         * @param log Receives the planner messages when the robot is verbose
+         */
+        std::vector<int> runPlanner(Map& on, int from, int to, SearchStats& stats, std::ostream& log);
+
+        /// Adds a search to the totals and the metrics
+        void recordSearch(const SearchStats& stats, double microseconds);
+
+        /**
+         * Handles a new path that is only the goal (no path): the robot stops, or waits for a scan
+         * to clear an obstacle (BeliefModel::LogOdds).
+         * @return False if there is no path
+         */
+        bool pathFound(const std::vector<int>& path);
+
+        /**
+         * Async planning: keeps the safe prefix of the path (up to the first tile now believed blocked)
+         * and asks the worker for a path from its last tile.
+         */
+        void requestPath();
+
+        /// Async planning: appends the worker's path to the safe prefix once the answer to the latest request is published
+        void adoptPath();
+
+        /// Tells the incremental planners about a belief change (queued for the worker with async planning)
+        void notifyPlanners(int tile);
+
+        /**
+         * Runs the range scanner and marks the obstacles it finds on robotMap.
+         */
+        bool scanSurroundings();
+
+        /**
+         * Copies a belief change to robotMap and tells the incremental planners.
+         */
+        void setBelief(int tile, bool blocked);
 
     public: 
-        Robot(Map * m, int x_init, int y_init, int initR, sf::RenderWindow * w);
+        /**
+         * @param m True map the robot senses. The robot only reads it, except for the path highlight (see setPathHighlight).
+         * @param x_init Initial x position in pixels
+         * @param y_init Initial y position in pixels
+         * @param initR Radius of the robot
+         * @param log Log planning and sensing events on std::cout
+         * @param prior Belief the robot starts from (copied, its pages are shared); nullptr for m->cloneBelief()
+         * @param store Store holding the robot's kinematic state (a slot is added), so a fleet can move its robots in
+         *              one pass (RobotStates::advance); nullptr for a store of its own. It must outlive the robot.
+         */
+        Robot(Map * m, int x_init, int y_init, int initR, bool log = true, const Map * prior = nullptr, RobotStates * store = nullptr);
+
+        /// Not copyable nor movable: states, the sensors, the planners and the worker's job point back into the robot
+        Robot(const Robot&) = delete;
+        Robot(Robot&&) = delete;
+        Robot& operator=(const Robot&) = delete;
+        Robot& operator=(Robot&&) = delete;
         
         void setX(int new_x);
         void setY(int new_y);
         
-        void setCanRunAlgo(bool b){canRunAlgo = b;}
-        void setStartTile(int i){startTile = i; currentTile =i;}
-        void setEndTile(int i){endTile= i;}
+        void setCanRunAlgo(bool b){canRunAlgo = b; stopCruise();}
+        void setPlannerType(PlannerType p){plannerType = p;}
+        void setVerbose(bool b){verbose = b;}
+        void setPathHighlight(bool b){highlightPath = b;}
+
+        /**
+         * Runs the path searches on a background thread (see PlanWorker), so update() never waits for a search.
+         * While a search runs the robot follows the part of its path still believed free, then waits on its
+         * last tile; a search made stale by a newer obstacle is dropped. Call it before the robot starts.
+         * The timeline then depends on how fast the searches are: runs are not reproducible tick for tick.
+         */
+        void setAsyncPlanning(bool b);
+        bool isAsyncPlanning() const {return planWorker != nullptr;}
+        /// Searches dropped because a newer obstacle was found before their path was used (async planning)
+        long getCancelledPlans() const {return planWorker ? planWorker->getCancelled() : 0;}
+
+        /// Async planning: the robot has no safe tile left to move to, so its ticks only wait for the worker
+        bool isWaitingForPlan() const {return planPending && states->step[slot] >= int(pathToFollow.size());}
+
+        /**
+         * Blocks until the worker publishes the path the robot waits for (see isWaitingForPlan); the next update
+         * takes it. A runner stepping as fast as it can calls it, so waiting for a search does not use up ticks.
+         */
+        void waitForPlan(){if(isWaitingForPlan()) planWorker->wait(planGeneration);}
+
+        /**
+         * Records the robot's metrics in a registry: replans and sensor hits (labelled robot=id),
+         * nodes expanded/pushed, latency (microseconds) and path length of each search, ticks to goal.
+         * The metrics are looked up once here, so recording them in update() is only atomic increments.
+         * Search metrics are labelled with the planner: call it after setPlannerType.
+         * @param registry Registry to record into (nullptr stops recording). It must outlive the robot.
+         * @param id Robot identifier used in the labels
+         */
+        void setMetrics(MetricsRegistry * registry, int id);
+
+        /**
+         * Keeps the list of the obstacles the robot discovers, until clearNewDiscoveries (used by TraceRecorder).
+         * Obstacles cleared by a log-odds belief are listed too: each entry is (tile, true if it is now an obstacle).
+         */
+        void setDiscoveryLog(bool b){logDiscoveries = b; newDiscoveries.clear();}
+        const std::vector<std::pair<int, bool>>& getNewDiscoveries() const {return newDiscoveries;}
+        void clearNewDiscoveries(){newDiscoveries.clear();}
+
+        /**
+         * Enables the range scanner: every time the robot enters a tile it casts 'rays' rays up to
+         * 'range' tiles away, so obstacles are discovered before the robot is next to them.
+         * A range of 0 disables it (only the four adjacent-tile sensors are used).
+         */
+        void setRangeScan(int rays, int range){scanner.configure(rays, range); lastScanTile = -1; stopCruise();}
+
+        /**
+         * Makes the range scanner noisy (see RayScanner::setNoise). The adjacent-tile sensors stay exact.
+         */
+        void setScanNoise(double falseHit, double missedHit, unsigned seed){scanner.setNoise(falseHit, missedHit, seed);}
+
+        /**
+         * Selects how readings update the belief map. Call it before the robot starts.
+         *
+         * With BeliefModel::LogOdds the range scans go through an OccupancyGrid: a tile becomes an obstacle
+         * after repeated hits and becomes free again when later rays cross it, so a false reading neither
+         * blocks the robot for good nor makes it replan on every scan. A robot that finds no path keeps
+         * scanning for a while (MAX_WAIT_SCANS) before giving up, since phantom obstacles may clear.
+         * Adjacent-tile sensor hits are taken as certain.
+         */
+        void setBeliefModel(BeliefModel m);
+        BeliefModel getBeliefModel() const {return beliefModel;}
+        const OccupancyGrid& getOccupancy() const {return occupancy;}
+        /// Belief obstacles turned back into free space (BeliefModel::LogOdds)
+        long getClearedTiles() const {return clearedTiles;}
+
+        /// Scans a robot without a path does before giving up (BeliefModel::LogOdds), one every WAIT_SCAN_TICKS
+        static const int MAX_WAIT_SCANS = 20;
+        static const int WAIT_SCAN_TICKS = 10;
+
+        /// Landmarks of PlannerType::Landmarks (LANDMARKS ints per tile), rebuilt once the belief changed LANDMARK_REBUILD times
+        static const int LANDMARKS = 8;
+        static const int LANDMARK_REBUILD = 16;
+        PlannerType getPlannerType() const {return plannerType;}
+        void setStartTile(int i){startTile = i; currentTile =i; stopCruise();}
+        void setEndTile(int i){endTile= i; robotMap.setCellState(i, CellState::Goal);}
+        int getEndTile() const {return endTile;}
         
+        /**
+         * Makes the robot follow a timed path (see MultiAgentPlanner) instead of planning on its own:
+         * timedPath[t] is the tile at step t, a repeated tile is a wait, and each step (move or wait)
+         * lasts getStepTicks() ticks, so robots given paths at the same tick stay in step.
+         * The path must start on the current tile and avoid the obstacles of the true map: it is not replanned.
+         */
+        void followPlan(const std::vector<int>& timedPath);
+        bool isFollowingPlan() const {return followingPlan;}
+
+        /// Ticks needed to move to a neighbor tile (and to wait one step of a timed path)
+        int getStepTicks() const;
+
         /**
          * Main update function to move and control the robot's behavior on the map.
+         * Advances the simulation by one fixed step (see SimClock); it does not draw anything.
+         * Between two tiles a tick is a plain move done on the robot's RobotStates slot.
          */
-        void update(sf::RenderWindow& window);
+        void update();
+
+        /**
+         * Event-driven run: same as calling update() until the robot stops or maxTicks ticks were done,
+         * but the plain moves between two tiles are done at once (RobotStates::cruiseTicks), so only the
+         * ticks that reach a tile, sense an obstacle or plan cost anything. The true map must not change meanwhile.
+         * @return Number of ticks done
+         */
+        long run(long maxTicks);
+
+        /// True while the robot is following (or computing) a path
+        bool isRunning() const {return canRunAlgo;}
+        /// True once the robot has stepped on the end tile
+        bool hasReachedGoal() const {return goalReached;}
+        bool isPlaced() const {return robotPlaced;}
+
+        float getPosX() const {return states->posX[slot];}
+        float getPosY() const {return states->posY[slot];}
+        float getRadius() const {return float(r);}
+
+        /// Number of updates done while running
+        long getTicks() const {return states->ticks[slot];}
+        /// Number of path computations done so far (first plan included)
+        int getReplans() const {return replans;}
+        /// Accumulated planner work over all the path computations
+        const SearchStats& getPlannerTotals() const {return plannerTotals;}
+
+        /// Heap memory of the belief map (pages shared with the prior excluded), its log-odds and the D* Lite state
+        /// (left out with async planning: the worker owns it)
+        std::size_t getBeliefMemoryBytes() const {
+            return robotMap.getGrid().getMemoryBytes() + occupancy.getMemoryBytes() + (planWorker ? 0 : incrementalPlanner.getMemoryBytes());
+        }
 
         /// Movement in four directions
         void moveXpos();
@@ -78,6 +336,9 @@ class Robot{
 
         int  getCurrentTile(){return currentTile;}
 
+        /// Path currently followed (tile indices from the tile of the last replan to the end tile)
+        const std::vector<int>& getPath() const {return pathToFollow;}
+
         /// Phase3
         Map * getRobotMap(){return &robotMap;}
 
@@ -0,0 +1,61 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "GridGraph.h"
+
+/**
+ * Kinematic state of a set of robots, stored as a structure of arrays (one slot per robot).
+ *
+ * A Robot keeps its pose, speed, path step and tick count in a slot of a RobotStates: its own
+ * when it runs alone, the World's one for a fleet. Between two tiles a robot only moves by its
+ * speed toward the center of the next tile, so after each full Robot::update the robot tells
+ * whether its next tick is such a plain move (it is "cruising") and where it is heading.
+ * advance() then does the plain moves of the whole fleet with SIMD kernels over the arrays, and
+ * hands back the robots that need a full update: the ones that are not cruising, reach their
+ * target tile, or whose target tile is blocked on the true map (the sensor would see it).
+ */
+class RobotStates {
+    public:
+        static const std::int32_t CRUISING = 1; /// flags bit: the next tick is a plain move toward (targetX, targetY)
+
+        std::vector<float> posX, posY; /// Top-left corner of the robot's bounding box, in pixels
+        std::vector<float> targetX, targetY; /// Position of the robot on the center of its target tile
+        std::vector<float> stepX, stepY; /// Move of one tick toward the target (cruising robots)
+        std::vector<float> speed; /// Distance covered by one tick, in pixels
+        std::vector<int> targetTile; /// Tile the robot is moving to (cruising robots)
+        std::vector<int> step; /// Index of the target tile in the robot's path
+        std::vector<long> ticks; /// Updates done while running
+        std::vector<std::int32_t> flags; /// 32-bit, like the floats, so advance() keeps one lane per robot
+
+        /// Adds a slot (robot at rest at (x, y))
+        int add(float x, float y, float robotSpeed);
+        int size() const {return int(posX.size());}
+
+        /**
+         * Advances the robots of the set by one tick: moves the cruising robots that stay
+         * between tiles and lists the others in 'pending', in slot order. The moves are exactly
+         * the ones Robot::update would do.
+         * @param trueMap Occupancy of the true map, read by the robots' sensors
+         * @param pending Slots needing a full Robot::update this tick (cleared first)
+         */
+        void advance(const GridGraph& trueMap, std::vector<int>& pending);
+
+        /**
+         * Number of ticks slot i will only move before it needs a full update: 0 if it is not cruising
+         * or its target tile is blocked, NEVER if it would never get within 1 pixel of the target.
+         * Computed in closed form, it is the count advance() would reach tick after tick on a static true map.
+         */
+        long cruiseTicks(int i, const GridGraph& trueMap) const;
+
+        /// Does n plain moves of slot i at once (n must not exceed cruiseTicks)
+        void skip(int i, long n){
+            posX[i] += float(n) * stepX[i];
+            posY[i] += float(n) * stepY[i];
+            ticks[i] += n;
+        }
+
+        static constexpr long NEVER = 1L << 62; /// cruiseTicks of a robot that never reaches its target
+
+    private:
+        std::vector<std::int32_t> moving; /// Scratch of advance(): 1 if the slot moves this tick
+};
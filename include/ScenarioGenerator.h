@@ -0,0 +1,88 @@
+#pragma once
+#include <string>
+#include "GridGraph.h"
+#include "CostLayer.h"
+
+/**
+ * Families of procedurally generated maps.
+ */
+enum class MapKind {
+    Open, /// No obstacle
+    Random, /// Each tile blocked independently with probability 'density'
+    Maze, /// Perfect maze: one-tile corridors, exactly one route between two corridor tiles
+    Rooms /// Rooms split by walls with doors, cluttered with obstacles of probability 'density'
+};
+
+/**
+ * Converts a MapKind enum value to its string representation (also the name parsed by mapKindFromString).
+ */
+inline const char* mapKindToString(MapKind k) {
+    switch(k) {
+        case MapKind::Open: return "open";
+        case MapKind::Random: return "random";
+        case MapKind::Maze: return "maze";
+        case MapKind::Rooms: return "rooms";
+        default: return "unknown";
+    }
+}
+
+/**
+ * Parses a map kind name ("open", "random", "maze" or "rooms").
+ * @return False if the name is unknown
+ */
+inline bool mapKindFromString(const std::string& name, MapKind& kind) {
+    for(MapKind k : {MapKind::Open, MapKind::Random, MapKind::Maze, MapKind::Rooms}){
+        if(name == mapKindToString(k)){
+            kind = k;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Everything needed to rebuild one scenario: the same spec always gives the same map, start and goal.
+ */
+struct ScenarioSpec {
+    MapKind kind = MapKind::Random;
+    int cols = 16;
+    int rows = 12;
+    double density = 0.2; /// Obstacle probability (random and rooms maps)
+    unsigned seed = 1;
+};
+
+/**
+ * Procedural maps for headless evaluation runs.
+ *
+ * Every generator is deterministic for a given seed (std::mt19937), so a scenario is fully
+ * described by its ScenarioSpec.
+ */
+class ScenarioGenerator {
+    public:
+        static GridGraph randomGrid(int cols, int rows, double density, unsigned seed);
+
+        /**
+         * Perfect maze (iterative depth-first backtracker): corridors on even coordinates, walls elsewhere.
+         */
+        static GridGraph mazeGrid(int cols, int rows, unsigned seed);
+
+        /**
+         * Rooms by recursive division: each wall splits a region in two and has one door.
+         * Regions narrower than 2*minRoom+1 tiles are not split. Rooms are then cluttered
+         * with random obstacles (never on a door or in front of one).
+         */
+        static GridGraph roomsGrid(int cols, int rows, double density, unsigned seed, int minRoom = 4);
+
+        /**
+         * Terrain costs: open ground costs 2, with slow zones (rectangles costing 6 to 9) and
+         * preferred lanes (whole rows and columns costing 1, drawn over the slow zones).
+         */
+        static CostLayer terrainCosts(int cols, int rows, unsigned seed);
+
+        /**
+         * Builds the map of a spec and draws a start and a goal in the same connected region,
+         * preferably at least (cols+rows)/4 steps apart.
+         * @return False if the map has no two connected free tiles
+         */
+        static bool generate(const ScenarioSpec& spec, GridGraph& grid, int& start, int& goal);
+};
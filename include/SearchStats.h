@@ -0,0 +1,17 @@
+#pragma once
+
+/**
+ * Counters filled by the path planners for each search (or repair).
+ * They make the work done by different planners comparable on the same map.
+ */
+struct SearchStats {
+    long expanded = 0; /// Nodes popped from the open list and expanded
+    long pushed = 0;   /// Entries pushed on the open list (including re-insertions)
+
+    /// Accumulates another search into this one
+    SearchStats& operator+=(const SearchStats& o){
+        expanded += o.expanded;
+        pushed += o.pushed;
+        return *this;
+    }
+};
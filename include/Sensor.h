@@ -1,5 +1,4 @@
 #pragma once
-#include <SFML/Graphics.hpp>
 #include "Direction.h"
 
 /// Forward declarations to avoid circular includes
@@ -15,7 +14,7 @@ class Sensor{
         bool detectionChecked;  /// True if an obstacles is detected in the direction
         Direction d; /// Direction this sensors is facing
         Robot * robot; /// Pointer to the robot using this sensor 
-        Map * map; /// Pointer to the map
+        const Map * map; /// Pointer to the map (only read, through its occupancy grid)
     public: 
         /**
          * Constructs a Sensor. 
@@ -23,7 +22,7 @@ class Sensor{
          * @param r Pointer to the owning Robot
          * @param m Pointer to the Map where the Robot operates
          */
-        Sensor(Direction direction, Robot * r, Map * m);
+        Sensor(Direction direction, Robot * r, const Map * m);
 
         /**
          * Activates the sensor and checks for obstacles. 
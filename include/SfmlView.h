@@ -0,0 +1,29 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include "Map.h"
+#include "Robot.h"
+
+/**
+ * Thin SFML view over the simulation core.
+ * Map, Tile and Robot only hold simulation state; these helpers project that state on a window.
+ * Tile grids are drawn by TileRenderer.
+ */
+
+/**
+ * Converts a core Color to its SFML equivalent.
+ */
+inline sf::Color toSfColor(const Color& c){
+    return sf::Color(c.r, c.g, c.b, c.a);
+}
+
+/**
+ * Draws the robot as a red circle at its current position (only once it has been placed).
+ */
+void drawRobot(const Robot& robot, sf::RenderWindow& window);
+
+/**
+ * Draws a robot shape from a bare pose (e.g. decoded from a trace).
+ * @param x Left of the robot's bounding box, in pixels
+ * @param y Top of the robot's bounding box, in pixels
+ */
+void drawRobotAt(float x, float y, float radius, sf::RenderWindow& window, sf::Color color = sf::Color::Red);
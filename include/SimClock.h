@@ -0,0 +1,86 @@
+#pragma once
+#include <chrono>
+
+/**
+ * Fixed-timestep simulation clock.
+ *
+ * The simulation always advances by steps of the same simulated duration (one Robot::update per step),
+ * whatever the rendering frame rate: each frame, advance() runs the number of steps covering the wall
+ * time elapsed since the previous frame (times the fast-forward multiplier). The leftover time is kept
+ * for the next frame. Runs therefore give the same sequence of steps on any machine; only how many
+ * steps are shown per frame changes.
+ *
+ * In uncapped mode the clock ignores real time and runs steps until the frame budget of wall time is spent.
+ */
+class SimClock {
+    private:
+        double stepSeconds; /// Simulated duration of one step
+        double multiplier = 1.0; /// Fast-forward factor (simulated seconds per wall second)
+        bool uncapped = false; /// Run as many steps as fit in frameBudget, ignoring real time
+        double frameBudget = 1.0 / 60.0; /// Wall time spent on steps per frame in uncapped mode
+        int maxStepsPerFrame = 100000; /// Bound on the catch-up work of one frame (the rest is dropped)
+
+        double accumulator = 0.0; /// Simulated time due but not run yet
+        long steps = 0; /// Steps run since the start
+        double wallSeconds = 0.0; /// Wall time covered by the frames
+
+    public:
+        /**
+         * @param step Simulated seconds per step (default 1/120 s: a robot at 0.5 px per step moves 60 px/s)
+         */
+        explicit SimClock(double step = 1.0 / 120.0) : stepSeconds(step) {}
+
+        /**
+         * Runs the steps due for a frame that lasted frameSeconds of wall time.
+         * @param frameSeconds Wall time since the previous call
+         * @param step Callable running one simulation step
+         * @return Number of steps run
+         */
+        template<typename F>
+        int advance(double frameSeconds, F&& step){
+            wallSeconds += frameSeconds;
+            int done = 0;
+            if(uncapped){
+                auto begin = std::chrono::steady_clock::now();
+                std::chrono::duration<double> budget(frameBudget);
+                /// Check the time every 64 steps: reading the clock costs more than a step
+                while(done < maxStepsPerFrame){
+                    step();
+                    done++;
+                    if((done & 63) == 0 && std::chrono::steady_clock::now() - begin >= budget)
+                        break;
+                }
+                accumulator = 0.0;
+            }
+            else{
+                accumulator += frameSeconds * multiplier;
+                while(accumulator >= stepSeconds && done < maxStepsPerFrame){
+                    step();
+                    accumulator -= stepSeconds;
+                    done++;
+                }
+                if(done == maxStepsPerFrame)
+                    accumulator = 0.0; /// Too far behind: drop the backlog instead of spiralling
+            }
+            steps += done;
+            return done;
+        }
+
+        double getStepSeconds() const {return stepSeconds;}
+        long getSteps() const {return steps;}
+
+        /// Simulated time since the start, in seconds
+        double getSimTime() const {return steps * stepSeconds;}
+
+        /// Simulated seconds per wall second over the whole run
+        double getThroughput() const {return wallSeconds > 0.0 ? getSimTime() / wallSeconds : 0.0;}
+
+        void setMultiplier(double m){multiplier = m > 0.0 ? m : multiplier;}
+        double getMultiplier() const {return multiplier;}
+
+        void setUncapped(bool b){uncapped = b;}
+        bool isUncapped() const {return uncapped;}
+
+        void setFrameBudget(double seconds){frameBudget = seconds;}
+        void setMaxStepsPerFrame(int n){maxStepsPerFrame = n > 0 ? n : 1;}
+};
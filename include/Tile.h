@@ -1,5 +1,5 @@
 #pragma once
-#include <SFML/Graphics.hpp>
+#include "Color.h"
 /**
  * Enum representing different types of tiles in the map
  */
@@ -8,65 +8,73 @@ enum class TileType {
     Empty, /// Walkalble tile
     Obstacle, /// Non-walkable tile
     Start, /// Robot starting position
-    Goal /// Destination tile 
+    Goal /// Destination tile
 };
 
 /**
- * Class representing a single tile in the 2D grip map. 
- * Each tile is rendered as a quare and has a specific type
+ * Axis-aligned rectangle in window coordinates (same fields as sf::FloatRect)
+ */
+struct TileBounds {
+    float left;
+    float top;
+    float width;
+    float height;
+};
+
+/**
+ * Class representing a single tile in the 2D grip map.
+ * Each tile is a square with a specific type. It only stores its position and colors:
+ * the SFML view reads them to render the tile, so the tile itself has no graphics dependency.
  */
 class Tile {
     private:
-        sf::RectangleShape shape; /// The drawable square shape
+        float x; /// Top-left x position in the window
+        float y; /// Top-left y position in the window
+        Color fillColor = Color::White; /// Fill color of the square
+        Color borderColor = Color::Black; /// Outline color of the square
         TileType type; /// The tile's functional role
         int Size; /// Side length in pixels
-    public: 
+    public:
         /**
          * Constructs a tile at position (x,y) with size 's' and optional type
          * @param x X position in the window
          * @param y Y position in the window
-         * @param s Size of the square side 
+         * @param s Size of the square side
          * @param type Initial tile type (default is Empty)
          */
         Tile(float x, float y,  int s, TileType type = TileType::Empty);
-        
+
         /**
          * Sets the type of the tile and updates its color accordingly
          */
         void setType(TileType newType);
-        
+
         /**
          * Returns the current type of the tile
          */
         TileType getType() const;
-        
-        /**
-         * Renders the tile on the provided window
-         */
-        void draw(sf::RenderWindow& window) const;
 
-        /**
-         * Return a copy of the internal shape
-         */
-        sf::RectangleShape getShape();
-        
         /**
          * Sets the top-left position ofthe tile
          */
-        void setPosition(float x, float y){shape.setPosition(x,y);}
-        
+        void setPosition(float newX, float newY){x = newX; y = newY;}
+
         /**
          * Sets the fill color of the tile
          */
-        void setFillColor(const sf::Color& color){shape.setFillColor(color);}
-        
+        void setFillColor(const Color& color){fillColor = color;}
+
         /**
          * Sets the border color of the tile
          */
-        void setBorderColor(const sf::Color& color){shape.setOutlineColor(color);}
-        
+        void setBorderColor(const Color& color){borderColor = color;}
+
+        const Color& getFillColor() const {return fillColor;}
+        const Color& getBorderColor() const {return borderColor;}
+        int getSize() const {return Size;}
+
         /**
          * Returns the global boundind box of the tile
          */
-        sf::FloatRect getGlobalBounds() const { return shape.getGlobalBounds();}
-};
\ No newline at end of file
+        TileBounds getGlobalBounds() const { return {x, y, float(Size), float(Size)};}
+};
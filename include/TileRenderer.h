@@ -0,0 +1,36 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include "Map.h"
+
+/**
+ * Draws the whole tile grid of a map with a single vertex array (one draw call).
+ *
+ * Each tile is a filled square plus a 1 pixel outline ring, like the sf::RectangleShape the tiles
+ * used to be. Vertex positions are laid out once; afterwards update() only rewrites the colors of
+ * the tiles the map reports as dirty (see Map::getDirtyTiles).
+ */
+class TileRenderer : public sf::Drawable {
+    private:
+        static const int VERTICES_PER_TILE = 30; /// 2 triangles for the fill + 8 for the outline ring
+
+        Map * map; /// Watched map (the renderer consumes its dirty tile list)
+        sf::VertexArray vertices;
+        std::size_t tileCount = 0; /// Number of tiles the vertex array was built for
+
+        void rebuild();
+        void writeColors(int id);
+
+        void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+
+    public:
+        /**
+         * @param m Map to draw. It must outlive the renderer.
+         */
+        explicit TileRenderer(Map * m);
+
+        /**
+         * Brings the vertex array up to date with the map: full rebuild if the grid changed size,
+         * otherwise only the dirty tiles are rewritten. Clears the map's dirty list.
+         */
+        void update();
+};
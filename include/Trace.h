@@ -0,0 +1,231 @@
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "GridGraph.h"
+
+class Map;
+class Robot;
+
+/**
+ * Header of a trace file (32 bytes, little endian, host layout).
+ *
+ * The occupancy of the true map follows with the GridGraph layout (rows of (cols+63)/64 64-bit
+ * words), then the record stream until an END record.
+ */
+struct TraceHeader {
+    char magic[4]; /// "RSTR"
+    std::uint32_t version; /// Format version (TraceRecorder::VERSION)
+    std::uint32_t cols;
+    std::uint32_t rows;
+    std::uint32_t tileSize; /// Tile size in pixels
+    std::uint32_t robotCount;
+    std::uint32_t keyInterval; /// Ticks between two keyframes
+    float radius; /// Robot radius in pixels
+};
+static_assert(sizeof(TraceHeader) == 32, "TraceHeader must be 32 bytes");
+
+/**
+ * Record types of the trace stream. Every number is a LEB128 varint, signed ones zigzag encoded.
+ *
+ * Positions are fixed point (1/16 pixel). A robot moves by the same delta every tick until a VEL
+ * record changes it, so a robot driving along a corridor costs nothing between two tiles.
+ * The records of a tick follow its TICK record; ticks without any record are not written at all.
+ */
+enum class TraceRecord : std::uint8_t {
+    Tick = 0, /// dt: the next record(s) belong to tick (previous written tick + dt)
+    Key = 1, /// tick, then for every robot x, y, vx, vy (signed) and flags (1 = placed, 2 = goal reached)
+    Velocity = 2, /// robot, vx, vy (signed): per-tick delta from this tick on
+    Discovery = 3, /// robot, tile: obstacle found by the robot (marked on its belief map)
+    Path = 4, /// robot, n, first tile, n-1 signed deltas: new path after a replan
+    Goal = 5, /// robot: the robot reached its goal
+    Clear = 6, /// robot, tile: obstacle cleared from the robot's belief map (log-odds belief)
+    End = 7
+};
+
+/**
+ * Writes the trace of a run: after every tick, captureRobot() compares each robot with what the
+ * stream already predicts and only writes the differences.
+ *
+ * Recording a tick where nothing changes costs a few comparisons per robot and no I/O; records are
+ * accumulated in memory and written in 64 KB blocks.
+ */
+class TraceRecorder {
+    public:
+        static const std::uint32_t VERSION = 2;
+        static const int FIXED_POINT = 16; /// Position units per pixel
+
+    private:
+        /**
+         * What the stream predicts for one robot.
+         */
+        struct RobotState {
+            std::int32_t x = 0, y = 0; /// Last position (fixed point)
+            std::int32_t vx = 0, vy = 0; /// Delta of the last tick
+            int replans = 0;
+            bool placed = false;
+            bool goal = false;
+        };
+
+        std::ofstream out;
+        std::vector<std::uint8_t> buffer; /// Bytes not written to the file yet
+        std::vector<std::uint8_t> events; /// Records of the current tick
+        std::vector<RobotState> robots;
+        std::uint32_t keyInterval = 256;
+        long tick = 0; /// Tick being captured
+        long lastWrittenTick = 0; /// Tick of the last TICK record (or 0)
+        long bytesWritten = 0;
+        bool placementChanged = false; /// A robot was placed or removed during the tick: write a keyframe
+
+        void flush();
+
+    public:
+        ~TraceRecorder(){close();}
+
+        /**
+         * Creates the trace file and writes the header and the occupancy of the true map.
+         * @param robotCount Number of robots captured every tick (ids 0..robotCount-1)
+         * @param radius Robot radius in pixels, for the replay
+         * @param interval Ticks between two keyframes (seeking replays at most this many ticks)
+         * @return False (with a message on std::cerr) if the file cannot be written
+         */
+        bool open(const std::string& path, const Map& trueMap, int robotCount, float radius, std::uint32_t interval = 256);
+
+        bool isOpen() const {return out.is_open();}
+
+        /**
+         * Starts capturing a tick. Tick 0 is the state before the first update.
+         */
+        void beginTick(long t){tick = t; events.clear();}
+
+        /**
+         * Records the changes of one robot since the previous tick: velocity, path, discoveries and
+         * clears (the robot must log them, see Robot::setDiscoveryLog; they are consumed) and goal.
+         */
+        void captureRobot(int id, Robot& robot);
+
+        /**
+         * Writes the records of the tick, plus a keyframe every keyInterval ticks.
+         */
+        void endTick();
+
+        /**
+         * Writes the END record and closes the file.
+         */
+        void close();
+
+        /// Bytes written so far (header included)
+        long getBytesWritten() const {return bytesWritten + long(buffer.size());}
+};
+
+/**
+ * Loads a trace and replays it: the robots' poses, paths and discoveries are decoded from the
+ * stream, nothing is simulated. Seeking starts from the nearest keyframe before the target tick,
+ * so it decodes at most one keyframe interval.
+ */
+class TraceReader {
+    public:
+        /**
+         * Obstacle found by a robot, or cleared from its belief map.
+         */
+        struct Discovery {
+            long tick;
+            int robot;
+            int tile;
+            bool obstacle; /// False for a CLEAR record
+        };
+
+    private:
+        /**
+         * Replayed state of one robot.
+         */
+        struct RobotState {
+            std::int32_t x = 0, y = 0, vx = 0, vy = 0;
+            bool placed = false;
+            bool goal = false;
+        };
+
+        /**
+         * A record located in the stream.
+         */
+        struct Mark {
+            long tick;
+            std::size_t offset;
+        };
+
+        TraceHeader header{};
+        GridGraph occupancy;
+        std::vector<std::uint8_t> data; /// Whole file
+        std::size_t streamBegin = 0; /// Offset of the first record
+
+        std::vector<Mark> keyframes; /// Offset of every KEY record
+        std::vector<std::vector<Mark>> paths; /// Offset of every PATH record, per robot
+        std::vector<Discovery> discoveries; /// Every DISC and CLEAR record, in stream order
+        long lastTick = 0;
+
+        std::vector<RobotState> robots;
+        std::size_t cursor = 0; /// Next record to decode
+        long tick = 0; /// Tick of the replayed state
+        long writtenTick = 0; /// Tick of the last TICK record decoded
+        long nextEventTick = 0; /// Tick of the next TICK record (-1 at the end of the stream)
+        std::size_t nextEventOffset = 0; /// First record after that TICK record
+
+        mutable std::vector<std::vector<int>> pathCache; /// Decoded path per robot
+        mutable std::vector<std::size_t> pathCacheOffset; /// PATH record pathCache was decoded from
+
+        bool index();
+        void decodeKey(std::size_t& pos);
+        std::size_t applyEvents();
+        void locateNextEvent();
+
+    public:
+        /**
+         * Reads a trace file and indexes its keyframes, paths and discoveries.
+         * @return False (with a message on std::cerr) if the file cannot be read or is not a valid trace
+         */
+        bool load(const std::string& path);
+
+        int getCols() const {return int(header.cols);}
+        int getRows() const {return int(header.rows);}
+        int getTileSize() const {return int(header.tileSize);}
+        int getRobotCount() const {return int(header.robotCount);}
+        float getRadius() const {return header.radius;}
+
+        /// Occupancy of the true map
+        const GridGraph& getOccupancy() const {return occupancy;}
+
+        long getTick() const {return tick;}
+        long getLastTick() const {return lastTick;}
+
+        /**
+         * Advances the replay by one tick.
+         * @return False if the end of the trace was already reached
+         */
+        bool step();
+
+        /**
+         * Moves the replay to a tick (clamped to [0, getLastTick()]), forward or backward.
+         */
+        void seek(long t);
+
+        float getPosX(int robot) const {return float(robots[robot].x) / TraceRecorder::FIXED_POINT;}
+        float getPosY(int robot) const {return float(robots[robot].y) / TraceRecorder::FIXED_POINT;}
+        bool isPlaced(int robot) const {return robots[robot].placed;}
+        bool hasReachedGoal(int robot) const {return robots[robot].goal;}
+
+        /**
+         * Path the robot follows at the current tick (empty before its first plan).
+         */
+        const std::vector<int>& getPath(int robot) const;
+
+        /**
+         * Every discovery and clear of the trace, ordered by tick: applying them in order gives the belief map.
+         */
+        const std::vector<Discovery>& getDiscoveries() const {return discoveries;}
+
+        /**
+         * Number of discoveries made up to tick t included (they are the first ones of getDiscoveries()).
+         */
+        std::size_t countDiscoveriesUntil(long t) const;
+};
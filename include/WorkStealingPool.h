@@ -0,0 +1,53 @@
+#pragma once
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * Runs a batch of independent tasks of very uneven cost over several threads.
+ *
+ * The tasks are dealt to the workers in contiguous blocks, one deque per worker. A worker takes
+ * its own tasks from the back of its deque; once it is empty it steals from the front of another
+ * worker's deque, so a worker stuck on a long task hands the rest of its block to the others.
+ *
+ * Unlike WorkerPool (one loop per simulation tick, chunks of an atomic counter), threads are
+ * started for each run: a batch lasts long enough for that not to matter.
+ */
+class WorkStealingPool {
+    private:
+        /**
+         * Tasks of one worker. The lock is only contended when a thief visits.
+         */
+        struct Queue {
+            std::mutex mutex;
+            std::deque<int> tasks;
+        };
+
+        int threads;
+        std::vector<std::unique_ptr<Queue>> queues;
+        std::atomic<long> steals{0};
+
+        bool pop(int worker, int& task);
+        bool steal(int thief, int& task);
+        void workerLoop(int worker, const std::function<void(int, int)>& f);
+
+    public:
+        /**
+         * @param threadCount Threads running the tasks (the caller included). 0 uses std::thread::hardware_concurrency().
+         */
+        explicit WorkStealingPool(int threadCount = 0);
+
+        int getThreadCount() const {return threads;}
+
+        /**
+         * Calls f(task, worker) for every task in [0, n) and returns when all are done.
+         * worker is in [0, getThreadCount()): f can use it to index per-thread state.
+         */
+        void run(int n, const std::function<void(int task, int worker)>& f);
+
+        /// Tasks taken from another worker's deque during the last run
+        long getSteals() const {return steals.load(std::memory_order_relaxed);}
+};
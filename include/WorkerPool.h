@@ -0,0 +1,59 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Fixed pool of worker threads running parallel loops.
+ *
+ * parallelFor hands out the indices of a loop in small chunks through an atomic counter,
+ * so threads that finish early take more work. The calling thread takes part in the loop
+ * and the call returns only when every index has been processed.
+ *
+ * Waking a worker costs a condition variable round trip, so a short loop runs on the caller alone
+ * and a loop of few chunks only wakes as many workers as it has chunks.
+ */
+class WorkerPool {
+    private:
+        std::vector<std::thread> workers;
+        std::mutex mutex;
+        std::condition_variable wake; /// Signals a new loop (or shutdown) to the workers
+        std::condition_variable done; /// Signals the caller that every worker left the loop
+
+        const std::function<void(int)> * body = nullptr; /// Body of the current loop
+        int count = 0; /// Number of indices of the current loop
+        int chunk = 1; /// Indices taken at once
+        std::atomic<int> next{0}; /// Next index to hand out
+        unsigned generation = 0; /// Incremented for each loop
+        int slots = 0; /// Workers still allowed to join the current loop
+        int busy = 0; /// Workers that joined the current loop and have not left it
+        bool stopping = false;
+
+        void workerLoop();
+        void runChunks();
+
+    public:
+        /**
+         * @param threads Total number of threads taking part in a loop (the caller included).
+         *                0 uses std::thread::hardware_concurrency().
+         */
+        explicit WorkerPool(int threads = 0);
+        ~WorkerPool();
+
+        WorkerPool(const WorkerPool&) = delete;
+        WorkerPool& operator=(const WorkerPool&) = delete;
+
+        /// Number of threads taking part in a loop, the caller included
+        int getThreadCount() const {return int(workers.size()) + 1;}
+
+        /// Loops with fewer indices than INLINE_PER_THREAD per thread run on the caller alone
+        static const int INLINE_PER_THREAD = 2;
+
+        /**
+         * Calls f(i) for every i in [0, n), spread over the pool. Calls must not overlap.
+         */
+        void parallelFor(int n, const std::function<void(int)>& f);
+};
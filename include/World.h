@@ -0,0 +1,102 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include "Map.h"
+#include "Robot.h"
+#include "PlannerType.h"
+#include "WorkerPool.h"
+#include "BucketQueue.h"
+#include "Metrics.h"
+#include "MultiAgentPlanner.h"
+
+/**
+ * A fleet of robots moving on one shared true map.
+ *
+ * Every robot has its own belief map, goal, sensors and planner state; the true map is only read
+ * while the fleet is stepped. Each tick updates all the robots in parallel on a worker pool.
+ * Since a robot's update only depends on its own state and on the (read-only) true map, the
+ * result of a run is the same whatever the number of threads.
+ *
+ * The robots keep their pose in one RobotStates: a tick first moves every robot that is between
+ * two tiles in one pass over its arrays, and only the others run a full Robot::update.
+ */
+class World {
+    private:
+        Map * map; /// Shared true map (must not be modified while step() runs)
+        Map prior; /// Belief every robot starts from: the robots' belief maps share its pages
+        RobotStates states; /// Kinematic state of every robot, slot i for robot i
+        std::vector<std::unique_ptr<Robot>> robots; /// Robots are not movable (their sensors point back to them)
+        std::vector<int> pending; /// Robots needing a full update in the current step
+        WorkerPool pool;
+        MultiAgentPlanner teamPlanner; /// Cooperative paths over the true map (see planCooperative)
+        long tick = 0; /// Number of steps done so far
+        MetricsRegistry * metrics = nullptr; /// Registry the robots record into (optional)
+        bool eventDriven = false; /// run() jumps from one robot event to the next (see setEventDriven)
+        BucketQueue events; /// Timing wheel of the event-driven run: robot i keyed by the tick of its next full update
+        std::vector<long> clocks; /// Tick up to which each robot's state is current (event-driven run)
+
+        long runEvents(long maxTicks);
+
+    public:
+        /**
+         * @param trueMap Map shared by every robot. It must outlive the world. Its blank belief (Map::cloneBelief)
+         *                is the prior of every robot.
+         * @param threads Number of threads stepping the robots (0 = one per hardware thread)
+         */
+        explicit World(Map * trueMap, int threads = 0);
+
+        /**
+         * Adds a robot placed on startTile and heading to goalTile, ready to run.
+         * Fleet robots are quiet and do not color their path on the shared map.
+         * @return The new robot
+         */
+        Robot& addRobot(int startTile, int goalTile, PlannerType planner = PlannerType::DStarLite);
+
+        /**
+         * Makes the robots added from now on record their metrics in registry (robot i is labelled robot=i).
+         * The registry is thread-safe to update, so the fleet can still be stepped in parallel.
+         */
+        void setMetrics(MetricsRegistry * registry){metrics = registry;}
+
+        /**
+         * Plans the whole fleet together on the true map (MultiAgentPlanner), so the robots neither collide
+         * nor deadlock in corridors, and makes every robot follow its timed path (Robot::followPlan).
+         * Robots must stand on distinct tiles and have distinct goals. The planner keeps its distance fields,
+         * so planning again with the same goals (e.g. after a robot was moved) only runs the space-time searches.
+         * @return The work and result of the planning
+         */
+        const MultiAgentStats& planCooperative(MultiAgentMode mode = MultiAgentMode::Prioritized);
+
+        /**
+         * Advances every robot by one tick: plain moves in one pass (RobotStates::advance), full updates in parallel.
+         */
+        void step();
+
+        /**
+         * Steps the fleet until every robot stopped or maxTicks steps were done.
+         * @return Number of steps done by this call
+         */
+        long run(long maxTicks);
+
+        /**
+         * Makes run() event-driven: each robot is woken only on the ticks where it reaches a tile, senses an
+         * obstacle or plans (RobotStates::cruiseTicks gives the next one in closed form), and the ticks where
+         * no robot wakes are skipped. The robots do exactly what step() would make them do, and when run()
+         * returns every robot is where it would be after the same number of steps.
+         */
+        void setEventDriven(bool b){eventDriven = b;}
+        bool isEventDriven() const {return eventDriven;}
+
+        int getRobotCount() const {return int(robots.size());}
+        Robot& getRobot(int i){return *robots[i];}
+        const Robot& getRobot(int i) const {return *robots[i];}
+
+        /// Number of robots still following (or computing) a path
+        int getRunningCount() const;
+
+        long getTick() const {return tick;}
+
+        /// Heap memory of the robots' belief maps (what they discovered; the shared prior is counted once)
+        std::size_t getBeliefMemoryBytes() const;
+        int getThreadCount() const {return pool.getThreadCount();}
+};
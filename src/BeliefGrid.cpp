@@ -0,0 +1,91 @@
+#include "BeliefGrid.h"
+#include <algorithm>
+
+namespace {
+
+/**
+ * Packs the even bits of x (bits 0, 2, ..., 62) into its low 32 bits.
+ */
+std::uint64_t packEvenBits(std::uint64_t x){
+    x &= 0x5555555555555555ull;
+    x = (x | (x >> 1)) & 0x3333333333333333ull;
+    x = (x | (x >> 2)) & 0x0F0F0F0F0F0F0F0Full;
+    x = (x | (x >> 4)) & 0x00FF00FF00FF00FFull;
+    x = (x | (x >> 8)) & 0x0000FFFF0000FFFFull;
+    x = (x | (x >> 16)) & 0x00000000FFFFFFFFull;
+    return x;
+}
+
+}
+
+void BeliefGrid::resize(int gridCols, int gridRows){
+    cols = gridCols;
+    rows = gridRows;
+    const int side = PAGE * BLOCK;
+    blockCols = (cols + side - 1) / side;
+    std::size_t count = std::size_t(blockCols) * ((rows + side - 1) / side);
+    blocks.clear();
+    blocks.resize(count);
+}
+
+/**
+ * A use count of 1 means no other grid (or block) can reach the block or page, so it is written in place.
+ * A count read above 1 while the other holder goes away only costs an extra clone.
+ */
+BeliefGrid::Page& BeliefGrid::writablePage(int r, int c){
+    std::shared_ptr<Block>& b = blocks[std::size_t(r >> 10) * blockCols + (c >> 10)];
+    if(!b)
+        b = std::make_shared<Block>();
+    else if(b.use_count() > 1)
+        b = std::make_shared<Block>(*b); /// The clone shares the pages of the original
+    std::shared_ptr<Page>& p = b->pages[((r >> 6) & (BLOCK - 1)) * BLOCK + ((c >> 6) & (BLOCK - 1))];
+    if(!p)
+        p = std::make_shared<Page>();
+    else if(p.use_count() > 1)
+        p = std::make_shared<Page>(*p);
+    return *p;
+}
+
+void BeliefGrid::set(int id, CellState s){
+    int r = id / cols;
+    int c = id - r * cols;
+    if(s == CellState::Unknown && !findPage(r, c))
+        return;
+    Page& p = writablePage(r, c);
+    std::uint64_t& w = p.words[(r & (PAGE - 1)) * 2 + ((c >> 5) & 1)];
+    int shift = 2 * (c & 31);
+    w = (w & ~(std::uint64_t(3) << shift)) | (std::uint64_t(s) << shift);
+}
+
+std::uint64_t BeliefGrid::blockedWord(int r, int w) const {
+    const Page * p = findPage(r, w << 6);
+    if(!p)
+        return 0;
+    std::uint64_t lo = p->words[(r & (PAGE - 1)) * 2];
+    std::uint64_t hi = p->words[(r & (PAGE - 1)) * 2 + 1];
+    /// Blocked (3) is the only state whose two bits are set
+    return packEvenBits(lo & (lo >> 1)) | (packEvenBits(hi & (hi >> 1)) << 32);
+}
+
+int BeliefGrid::getPageCount() const {
+    int count = 0;
+    for(const auto& b : blocks){
+        if(!b || b.use_count() > 1)
+            continue;
+        for(const auto& p : b->pages)
+            count += p && p.use_count() == 1;
+    }
+    return count;
+}
+
+std::size_t BeliefGrid::getMemoryBytes() const {
+    std::size_t bytes = blocks.capacity() * sizeof(blocks[0]);
+    for(const auto& b : blocks){
+        if(!b || b.use_count() > 1)
+            continue;
+        bytes += sizeof(Block);
+        for(const auto& p : b->pages)
+            bytes += p && p.use_count() == 1 ? sizeof(Page) : 0;
+    }
+    return bytes;
+}
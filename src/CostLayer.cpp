@@ -0,0 +1,45 @@
+#include "CostLayer.h"
+
+void CostLayer::clear(){
+    cols = rows = 0;
+    owned.reset();
+    view = nullptr;
+    external.reset();
+}
+
+void CostLayer::assign(int gridCols, int gridRows, std::uint8_t cost){
+    cols = gridCols;
+    rows = gridRows;
+    external.reset();
+    owned = std::make_shared<std::vector<std::uint8_t>>(std::size_t(cols) * rows, cost ? cost : 1);
+    view = owned->data();
+}
+
+void CostLayer::attach(int gridCols, int gridRows, const std::uint8_t * data, std::shared_ptr<const void> owner){
+    cols = gridCols;
+    rows = gridRows;
+    owned.reset();
+    view = data;
+    external = std::move(owner);
+}
+
+/**
+ * Copies external or shared bytes first, so no other layer sees the change.
+ */
+void CostLayer::set(int gridCols, int gridRows, int id, std::uint8_t cost){
+    if(!view)
+        assign(gridCols, gridRows, 1);
+    else if(external || owned.use_count() > 1){
+        owned = std::make_shared<std::vector<std::uint8_t>>(view, view + std::size_t(cols) * rows);
+        view = owned->data();
+        external.reset();
+    }
+    (*owned)[id] = cost ? cost : 1;
+}
+
+void CostLayer::copyTo(std::vector<std::uint8_t>& out, int gridCols, int gridRows) const {
+    std::size_t cells = std::size_t(gridCols) * gridRows;
+    out.resize(cells);
+    for(std::size_t i = 0; i < cells; i++)
+        out[i] = get(int(i));
+}
@@ -0,0 +1,172 @@
+#include "DStarLite.h"
+#include "Map.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+namespace {
+const float INF = std::numeric_limits<float>::infinity();
+}
+
+bool DStarLite::isBlocked(int id) const {
+    return map->getGrid().isBlocked(id);
+}
+
+/**
+ * Manhattan distance between two tiles: admissible on the 4-connected unit-cost grid.
+ */
+float DStarLite::heuristic(int a, int b) const {
+    return float(std::abs(a / cols - b / cols) + std::abs(a % cols - b % cols));
+}
+
+/**
+ * Cost of the edge between two neighbor tiles: 1, or infinity if either end is an obstacle.
+ */
+float DStarLite::cost(int a, int b) const {
+    if(isBlocked(a) || isBlocked(b))
+        return INF;
+    return 1.0f;
+}
+
+DStarLite::Key DStarLite::calculateKey(int s) const {
+    float m = std::min(g[s], rhs[s]);
+    return {m + heuristic(start, s) + km, m};
+}
+
+void DStarLite::insert(int s, Key k){
+    openKey[s] = k;
+    inOpen[s] = 1;
+    open.emplace(k, s);
+    lastStats.pushed++;
+}
+
+/**
+ * Returns min over the neighbors s' of c(s,s') + g(s'), and the neighbor reaching it in *next.
+ */
+float DStarLite::bestSuccessor(int s, int * next) const {
+    float best = INF;
+    int bestId = -1;
+    forEachNeighbor(s, [&](int n){
+        float v = cost(s, n) + g[n];
+        if(v < best){
+            best = v;
+            bestId = n;
+        }
+    });
+    if(next)
+        *next = bestId;
+    return best;
+}
+
+/**
+ * Recomputes rhs(s) and puts s in the open list if it is locally inconsistent (g != rhs).
+ */
+void DStarLite::updateVertex(int s){
+    if(s != goal)
+        rhs[s] = bestSuccessor(s, nullptr);
+    inOpen[s] = 0; /// Any entry still in the heap becomes stale
+    if(g[s] != rhs[s])
+        insert(s, calculateKey(s));
+}
+
+/**
+ * Expands inconsistent vertices until the start is consistent and no open key is smaller than its key.
+ */
+void DStarLite::computeShortestPath(){
+    while(true){
+        /// Drop stale entries left by lazy deletion
+        while(!open.empty()){
+            const Entry& top = open.top();
+            if(inOpen[top.second] && openKey[top.second] == top.first)
+                break;
+            open.pop();
+        }
+        Key topKey = open.empty() ? Key(INF, INF) : open.top().first;
+        if(!(topKey < calculateKey(start)) && rhs[start] == g[start])
+            break;
+        if(open.empty())
+            break;
+
+        int u = open.top().second;
+        open.pop();
+        inOpen[u] = 0;
+        lastStats.expanded++;
+
+        Key newKey = calculateKey(u);
+        if(topKey < newKey){
+            insert(u, newKey);
+        }
+        else if(g[u] > rhs[u]){
+            g[u] = rhs[u];
+            forEachNeighbor(u, [&](int n){ updateVertex(n); });
+        }
+        else{
+            g[u] = INF;
+            updateVertex(u);
+            forEachNeighbor(u, [&](int n){ updateVertex(n); });
+        }
+    }
+}
+
+/**
+ * Initializes the search state for a new start/goal pair and runs the initial (full) search.
+ */
+void DStarLite::reset(int startTile, int goalTile){
+    cols = map->getCols();
+    rows = map->getRows();
+    bool chunked = map->getGrid().isChunked();
+
+    g.assign(cols, rows, INF, chunked);
+    rhs.assign(cols, rows, INF, chunked);
+    openKey.assign(cols, rows, Key(INF, INF), chunked);
+    inOpen.assign(cols, rows, 0, chunked);
+    open = decltype(open)();
+
+    km = 0.0f;
+    start = lastStart = startTile;
+    goal = goalTile;
+    rhs[goal] = 0.0f;
+
+    lastStats = SearchStats();
+    insert(goal, calculateKey(goal));
+    computeShortestPath();
+    fullStats = lastStats;
+}
+
+void DStarLite::notifyTileChanged(int id){
+    if(goal < 0)
+        return;
+    updateVertex(id);
+    forEachNeighbor(id, [&](int n){ updateVertex(n); });
+}
+
+std::vector<int> DStarLite::plan(int startTile){
+    if(startTile != lastStart){
+        km += heuristic(lastStart, startTile);
+        lastStart = startTile;
+    }
+    start = startTile;
+
+    lastStats = SearchStats();
+    computeShortestPath();
+
+    /// Walk down the g-values from the start to the goal
+    std::vector<int> path;
+    if(g[start] == INF)
+        return {goal};
+
+    int at = start;
+    path.push_back(at);
+    int maxSteps = rows * cols;
+    while(at != goal && maxSteps-- > 0){
+        int next = -1;
+        if(bestSuccessor(at, &next) == INF || next < 0)
+            return {goal};
+        at = next;
+        path.push_back(at);
+    }
+    if(at != goal)
+        return {goal};
+    return path;
+}
@@ -0,0 +1,85 @@
+#include "GridGraph.h"
+#include <algorithm>
+
+GridGraph::GridGraph(const GridGraph& o)
+    : cols(o.cols), rows(o.rows), wordsPerRow(o.wordsPerRow), bits(o.bits), external(o.external),
+      chunked(o.chunked), cells(o.cells) {
+    words = external ? o.words : bits.data();
+}
+
+GridGraph::GridGraph(GridGraph&& o) noexcept
+    : cols(o.cols), rows(o.rows), wordsPerRow(o.wordsPerRow), bits(std::move(o.bits)), external(std::move(o.external)),
+      chunked(o.chunked), cells(std::move(o.cells)) {
+    words = external ? o.words : bits.data();
+    o.words = nullptr;
+}
+
+GridGraph& GridGraph::operator=(const GridGraph& o){
+    if(this != &o){
+        GridGraph copy(o);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+GridGraph& GridGraph::operator=(GridGraph&& o) noexcept {
+    if(this != &o){
+        cols = o.cols;
+        rows = o.rows;
+        wordsPerRow = o.wordsPerRow;
+        bits = std::move(o.bits);
+        external = std::move(o.external);
+        chunked = o.chunked;
+        cells = std::move(o.cells);
+        words = external ? o.words : bits.data();
+        o.words = nullptr;
+    }
+    return *this;
+}
+
+void GridGraph::resize(int gridCols, int gridRows){
+    cols = gridCols;
+    rows = gridRows;
+    wordsPerRow = (cols + 63) / 64;
+    external.reset();
+    chunked = false;
+    cells = BeliefGrid();
+    bits.assign(std::size_t(wordsPerRow) * rows, 0);
+    words = bits.data();
+}
+
+void GridGraph::resizeChunked(int gridCols, int gridRows){
+    cols = gridCols;
+    rows = gridRows;
+    wordsPerRow = (cols + 63) / 64;
+    external.reset();
+    bits.clear();
+    bits.shrink_to_fit();
+    words = nullptr;
+    chunked = true;
+    cells.resize(cols, rows);
+}
+
+void GridGraph::copyWords(std::uint64_t * out) const {
+    for(int r = 0; r < rows; r++)
+        for(int w = 0; w < wordsPerRow; w++)
+            *out++ = rowWord(r, w);
+}
+
+void GridGraph::attach(int gridCols, int gridRows, const std::uint64_t * data, std::shared_ptr<const void> owner){
+    cols = gridCols;
+    rows = gridRows;
+    wordsPerRow = (cols + 63) / 64;
+    bits.clear();
+    bits.shrink_to_fit();
+    chunked = false;
+    cells = BeliefGrid();
+    words = data;
+    external = std::move(owner);
+}
+
+void GridGraph::makeOwned(){
+    bits.assign(words, words + std::size_t(wordsPerRow) * rows);
+    words = bits.data();
+    external.reset();
+}
@@ -0,0 +1,354 @@
+#include "HierarchicalPlanner.h"
+#include "Map.h"
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <queue>
+
+namespace {
+/// Openings at least this long get a transition at each end instead of one in the middle
+const int LONG_ENTRANCE = 6;
+}
+
+bool HierarchicalPlanner::isBlocked(int id) const {
+    return map->getGrid().isBlocked(id);
+}
+
+/**
+ * Local index of a node tile in its cluster, or -1.
+ */
+int HierarchicalPlanner::findNode(int cluster, int tile) const {
+    const std::vector<int>& nodes = clusters[cluster].nodes;
+    for(int i = 0; i < int(nodes.size()); i++)
+        if(nodes[i] == tile)
+            return i;
+    return -1;
+}
+
+/**
+ * Splits the map into clusters and builds the whole abstract graph.
+ */
+void HierarchicalPlanner::build(){
+    cols = map->getCols();
+    rows = map->getRows();
+    clustersX = (cols + clusterSize - 1) / clusterSize;
+    clustersY = (rows + clusterSize - 1) / clusterSize;
+    clusters.assign(clustersX * clustersY, Cluster());
+    for(int cy = 0; cy < clustersY; cy++){
+        for(int cx = 0; cx < clustersX; cx++){
+            Cluster& cl = clusters[cy * clustersX + cx];
+            cl.x0 = cx * clusterSize;
+            cl.y0 = cy * clusterSize;
+            cl.width = std::min(clusterSize, cols - cl.x0);
+            cl.height = std::min(clusterSize, rows - cl.y0);
+        }
+    }
+    rightDirty.assign(clusters.size(), 1);
+    bottomDirty.assign(clusters.size(), 1);
+    clusterDirty.assign(clusters.size(), 1);
+    localDist.resize(clusterSize * clusterSize);
+    localParent.resize(clusterSize * clusterSize);
+    localQueue.resize(clusterSize * clusterSize);
+    pendingTiles.clear();
+    rebuiltClusters = 0;
+    applyChanges();
+}
+
+/**
+ * Marks the clusters and borders touched by the pending tiles, then rebuilds only those.
+ */
+void HierarchicalPlanner::applyChanges(){
+    for(int tile : pendingTiles){
+        int c = clusterOf(tile);
+        const Cluster& cl = clusters[c];
+        int lx = tile % cols - cl.x0;
+        int ly = tile / cols - cl.y0;
+        clusterDirty[c] = 1;
+        /// A border tile also changes the transitions shared with the cluster across that border
+        if(lx == 0 && cl.x0 > 0){
+            rightDirty[c - 1] = 1;
+            clusterDirty[c - 1] = 1;
+        }
+        if(lx == cl.width - 1 && c % clustersX < clustersX - 1){
+            rightDirty[c] = 1;
+            clusterDirty[c + 1] = 1;
+        }
+        if(ly == 0 && cl.y0 > 0){
+            bottomDirty[c - clustersX] = 1;
+            clusterDirty[c - clustersX] = 1;
+        }
+        if(ly == cl.height - 1 && c / clustersX < clustersY - 1){
+            bottomDirty[c] = 1;
+            clusterDirty[c + clustersX] = 1;
+        }
+    }
+    pendingTiles.clear();
+
+    for(int c = 0; c < int(clusters.size()); c++){
+        if(rightDirty[c]){
+            findTransitions(c, true);
+            rightDirty[c] = 0;
+        }
+        if(bottomDirty[c]){
+            findTransitions(c, false);
+            bottomDirty[c] = 0;
+        }
+    }
+    for(int c = 0; c < int(clusters.size()); c++){
+        if(clusterDirty[c]){
+            rebuildCluster(c);
+            clusterDirty[c] = 0;
+        }
+    }
+
+    nodeBase.assign(clusters.size() + 1, 0);
+    for(int c = 0; c < int(clusters.size()); c++)
+        nodeBase[c + 1] = nodeBase[c] + int(clusters[c].nodes.size());
+}
+
+/**
+ * Places the transitions on the right (or bottom) border of a cluster: each maximal run of
+ * tile pairs free on both sides gets one transition in its middle, or two at its ends if it is long.
+ */
+void HierarchicalPlanner::findTransitions(int cluster, bool right){
+    Cluster& cl = clusters[cluster];
+    std::vector<std::pair<int,int>>& out = right ? cl.rightTransitions : cl.bottomTransitions;
+    out.clear();
+    bool hasNeighbor = right ? cluster % clustersX < clustersX - 1 : cluster / clustersX < clustersY - 1;
+    if(!hasNeighbor)
+        return;
+
+    int length = right ? cl.height : cl.width;
+    /// Tile on this side of the border at position i, and the step to the tile across it
+    int first = right ? cl.y0 * cols + cl.x0 + cl.width - 1 : (cl.y0 + cl.height - 1) * cols + cl.x0;
+    int along = right ? cols : 1;
+    int across = right ? 1 : cols;
+
+    int runStart = -1;
+    for(int i = 0; i <= length; i++){
+        int here = first + i * along;
+        bool open = i < length && !isBlocked(here) && !isBlocked(here + across);
+        if(open && runStart < 0)
+            runStart = i;
+        if(!open && runStart >= 0){
+            int runEnd = i - 1;
+            if(runEnd - runStart + 1 >= LONG_ENTRANCE){
+                out.emplace_back(first + runStart * along, first + runStart * along + across);
+                out.emplace_back(first + runEnd * along, first + runEnd * along + across);
+            }
+            else{
+                int mid = first + (runStart + runEnd) / 2 * along;
+                out.emplace_back(mid, mid + across);
+            }
+            runStart = -1;
+        }
+    }
+}
+
+/**
+ * Collects the nodes of a cluster from the transitions on its four borders and computes
+ * the in-cluster distances between every pair of them.
+ */
+void HierarchicalPlanner::rebuildCluster(int cluster){
+    Cluster& cl = clusters[cluster];
+    cl.nodes.clear();
+    cl.links.clear();
+    auto addLink = [&](int tile, int partner){
+        int i = findNode(cluster, tile);
+        if(i < 0){
+            i = int(cl.nodes.size());
+            cl.nodes.push_back(tile);
+        }
+        cl.links.emplace_back(i, partner);
+    };
+    for(const auto& t : cl.rightTransitions) addLink(t.first, t.second);
+    for(const auto& t : cl.bottomTransitions) addLink(t.first, t.second);
+    if(cl.x0 > 0)
+        for(const auto& t : clusters[cluster - 1].rightTransitions) addLink(t.second, t.first);
+    if(cl.y0 > 0)
+        for(const auto& t : clusters[cluster - clustersX].bottomTransitions) addLink(t.second, t.first);
+
+    int n = int(cl.nodes.size());
+    cl.distances.assign(n * n, -1);
+    for(int i = 0; i < n; i++){
+        clusterSearch(cluster, cl.nodes[i]);
+        for(int j = 0; j < n; j++){
+            int t = cl.nodes[j];
+            cl.distances[i * n + j] = localDist[(t / cols - cl.y0) * cl.width + t % cols - cl.x0];
+        }
+    }
+    rebuiltClusters++;
+}
+
+void HierarchicalPlanner::clusterSearch(int cluster, int source){
+    const Cluster& cl = clusters[cluster];
+    std::fill(localDist.begin(), localDist.begin() + cl.width * cl.height, -1);
+    if(isBlocked(source))
+        return;
+
+    int s = (source / cols - cl.y0) * cl.width + source % cols - cl.x0;
+    int head = 0;
+    int tail = 0;
+    localDist[s] = 0;
+    localParent[s] = -1;
+    localQueue[tail++] = s;
+    lastStats.pushed++;
+    while(head < tail){
+        int u = localQueue[head++];
+        lastStats.expanded++;
+        int x = u % cl.width;
+        int y = u / cl.width;
+        auto visit = [&](int v, int vx, int vy){
+            if(localDist[v] >= 0 || isBlocked((cl.y0 + vy) * cols + cl.x0 + vx))
+                return;
+            localDist[v] = localDist[u] + 1;
+            localParent[v] = u;
+            localQueue[tail++] = v;
+            lastStats.pushed++;
+        };
+        if(y > 0) visit(u - cl.width, x, y - 1);
+        if(y < cl.height - 1) visit(u + cl.width, x, y + 1);
+        if(x > 0) visit(u - 1, x - 1, y);
+        if(x < cl.width - 1) visit(u + 1, x + 1, y);
+    }
+}
+
+void HierarchicalPlanner::refine(int cluster, int from, int to, std::vector<int>& path){
+    const Cluster& cl = clusters[cluster];
+    clusterSearch(cluster, from);
+    size_t end = path.size();
+    int s = (from / cols - cl.y0) * cl.width + from % cols - cl.x0;
+    for(int at = (to / cols - cl.y0) * cl.width + to % cols - cl.x0; at != s; at = localParent[at])
+        path.push_back((cl.y0 + at / cl.width) * cols + cl.x0 + at % cl.width);
+    std::reverse(path.begin() + end, path.end());
+}
+
+std::vector<int> HierarchicalPlanner::findPath(int start, int goal){
+    lastStats = SearchStats();
+    if(!map)
+        return {goal};
+    if(cols != map->getCols() || rows != map->getRows())
+        build();
+    else if(!pendingTiles.empty())
+        applyChanges();
+    if(start == goal || isBlocked(start) || isBlocked(goal))
+        return {goal};
+
+    int startCluster = clusterOf(start);
+    int goalCluster = clusterOf(goal);
+    auto localIndex = [&](int cluster, int tile){
+        const Cluster& cl = clusters[cluster];
+        return (tile / cols - cl.y0) * cl.width + tile % cols - cl.x0;
+    };
+
+    /// Connect start and goal to the nodes of their clusters
+    const Cluster& sc = clusters[startCluster];
+    clusterSearch(startCluster, start);
+    std::vector<int> startDist(sc.nodes.size());
+    for(int i = 0; i < int(sc.nodes.size()); i++)
+        startDist[i] = localDist[localIndex(startCluster, sc.nodes[i])];
+    int direct = startCluster == goalCluster ? localDist[localIndex(startCluster, goal)] : -1;
+
+    const Cluster& gc = clusters[goalCluster];
+    clusterSearch(goalCluster, goal);
+    std::vector<int> goalDist(gc.nodes.size());
+    for(int i = 0; i < int(gc.nodes.size()); i++)
+        goalDist[i] = localDist[localIndex(goalCluster, gc.nodes[i])];
+
+    /// A* on the abstract graph: nodes 0..N-1, plus the start (N) and the goal (N+1)
+    int nodeCount = nodeBase.back();
+    int S = nodeCount;
+    int G = nodeCount + 1;
+    auto clusterOfNode = [&](int u){
+        if(u == S) return startCluster;
+        if(u == G) return goalCluster;
+        return int(std::upper_bound(nodeBase.begin(), nodeBase.end(), u) - nodeBase.begin()) - 1;
+    };
+    auto tileOfNode = [&](int u){
+        if(u == S) return start;
+        if(u == G) return goal;
+        int c = clusterOfNode(u);
+        return clusters[c].nodes[u - nodeBase[c]];
+    };
+    auto heuristic = [&](int tile){
+        return std::abs(tile / cols - goal / cols) + std::abs(tile % cols - goal % cols);
+    };
+
+    std::vector<int> g(nodeCount + 2, INT_MAX);
+    std::vector<int> previous(nodeCount + 2, -1);
+    std::vector<char> closed(nodeCount + 2, 0);
+    /// Queue entries: ((f, h), node)
+    typedef std::pair<std::pair<int, int>, int> Entry;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> pq;
+    g[S] = 0;
+    pq.push({{heuristic(start), heuristic(start)}, S});
+    lastStats.pushed++;
+
+    int u = -1;
+    auto relax = [&](int v, int w){
+        if(closed[v] || g[u] + w >= g[v])
+            return;
+        g[v] = g[u] + w;
+        previous[v] = u;
+        int h = heuristic(tileOfNode(v));
+        pq.push({{g[v] + h, h}, v});
+        lastStats.pushed++;
+    };
+
+    while(!pq.empty()){
+        u = pq.top().second;
+        pq.pop();
+        if(closed[u])
+            continue;
+        closed[u] = 1;
+        lastStats.expanded++;
+        if(u == G)
+            break;
+
+        if(u == S){
+            for(int j = 0; j < int(startDist.size()); j++)
+                if(startDist[j] >= 0)
+                    relax(nodeBase[startCluster] + j, startDist[j]);
+            if(direct >= 0)
+                relax(G, direct);
+            continue;
+        }
+
+        int c = clusterOfNode(u);
+        const Cluster& cl = clusters[c];
+        int i = u - nodeBase[c];
+        int n = int(cl.nodes.size());
+        for(int j = 0; j < n; j++)
+            if(j != i && cl.distances[i * n + j] >= 0)
+                relax(nodeBase[c] + j, cl.distances[i * n + j]);
+        for(const auto& link : cl.links){
+            if(link.first != i)
+                continue;
+            int other = clusterOf(link.second);
+            relax(nodeBase[other] + findNode(other, link.second), 1);
+        }
+        if(c == goalCluster && goalDist[i] >= 0)
+            relax(G, goalDist[i]);
+    }
+
+    if(g[G] == INT_MAX)
+        return {goal};
+
+    /// Refine the abstract path: edges inside a cluster become tiles, links across a border are one step
+    std::vector<int> abstractPath;
+    for(int at = G; at != -1; at = previous[at])
+        abstractPath.push_back(at);
+    std::reverse(abstractPath.begin(), abstractPath.end());
+
+    std::vector<int> path{start};
+    for(size_t k = 1; k < abstractPath.size(); k++){
+        int a = abstractPath[k - 1];
+        int b = abstractPath[k];
+        int ca = clusterOfNode(a);
+        if(ca == clusterOfNode(b))
+            refine(ca, tileOfNode(a), tileOfNode(b), path);
+        else
+            path.push_back(tileOfNode(b));
+    }
+    return path;
+}
@@ -0,0 +1,219 @@
+#include "JumpPointSearch.h"
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include <queue>
+
+namespace {
+typedef std::uint64_t Word;
+
+inline int lowestBit(Word w){ return __builtin_ctzll(w); }
+inline int highestBit(Word w){ return 63 - __builtin_clzll(w); }
+
+/// Directions a node may be expanded in, as a bit mask
+const unsigned UP = 1u << 0;
+const unsigned DOWN = 1u << 1;
+const unsigned LEFT = 1u << 2;
+const unsigned RIGHT = 1u << 3;
+}
+
+/**
+ * Jumps from tile (c, r) along its row in direction dx (+1 or -1).
+ * Stops on the first tile that is the goal or has a forced vertical neighbor, i.e. a free tile
+ * above/below whose counterpart behind (column - dx) is blocked.
+ * Whole 64-tile words are tested at once: blocked tiles, forced neighbors and the goal are or-ed
+ * into one candidate mask and the first set bit in the direction of motion is the answer.
+ * @return Column of the jump point, or -1 if the row ends or is blocked first.
+ */
+int JumpPointSearch::jumpHorizontal(int c, int r, int dx) const {
+    int x = c + dx;
+    if(x < 0 || x >= cols)
+        return -1;
+
+    int wordsPerRow = grid->getWordsPerRow();
+    int goalRow = goal / cols;
+    int goalCol = goal % cols;
+
+    /// Mask of forced vertical neighbors in word w of row nr, for a move in direction dx
+    auto forced = [&](int nr, int w) -> Word {
+        if(nr < 0 || nr >= rows)
+            return 0;
+        Word b = grid->rowWord(nr, w);
+        Word behind;
+        if(dx > 0){
+            Word prev = w > 0 ? grid->rowWord(nr, w - 1) : 0;
+            behind = (b << 1) | (prev >> 63);
+        }
+        else{
+            Word next = w + 1 < wordsPerRow ? grid->rowWord(nr, w + 1) : 0;
+            behind = (b >> 1) | (next << 63);
+        }
+        return ~b & behind;
+    };
+
+    if(dx > 0){
+        int lastWord = (cols - 1) >> 6;
+        Word padding = (cols & 63) ? (~Word(0) << (cols & 63)) : 0; /// Columns past the end act as walls
+        for(int w = x >> 6; w <= lastWord; w++){
+            Word blocked = grid->rowWord(r, w);
+            if(w == lastWord)
+                blocked |= padding;
+            Word candidates = blocked | forced(r - 1, w) | forced(r + 1, w);
+            if(r == goalRow && (goalCol >> 6) == w)
+                candidates |= Word(1) << (goalCol & 63);
+            if(w == (x >> 6))
+                candidates &= ~Word(0) << (x & 63);
+            if(candidates){
+                int pos = (w << 6) + lowestBit(candidates);
+                if(pos >= cols || ((blocked >> (pos & 63)) & 1))
+                    return -1;
+                return pos;
+            }
+        }
+    }
+    else{
+        for(int w = x >> 6; w >= 0; w--){
+            Word blocked = grid->rowWord(r, w);
+            Word candidates = blocked | forced(r - 1, w) | forced(r + 1, w);
+            if(r == goalRow && (goalCol >> 6) == w)
+                candidates |= Word(1) << (goalCol & 63);
+            if(w == (x >> 6) && (x & 63) != 63)
+                candidates &= (Word(1) << ((x & 63) + 1)) - 1;
+            if(candidates){
+                int pos = (w << 6) + highestBit(candidates);
+                if((blocked >> (pos & 63)) & 1)
+                    return -1;
+                return pos;
+            }
+        }
+    }
+    return -1;
+}
+
+/**
+ * Jumps from tile (c, r) along its column in direction dy (+1 or -1).
+ * Horizontal moves are natural after a vertical one, so a tile is a jump point as soon as a
+ * horizontal jump from it finds one.
+ * @return Row of the jump point, or -1 if the column ends or is blocked first.
+ */
+int JumpPointSearch::jumpVertical(int c, int r, int dy) const {
+    for(int y = r + dy; y >= 0 && y < rows; y += dy){
+        int id = y * cols + c;
+        if(grid->isBlocked(id))
+            return -1;
+        if(id == goal)
+            return y;
+        if(jumpHorizontal(c, y, 1) >= 0 || jumpHorizontal(c, y, -1) >= 0)
+            return y;
+    }
+    return -1;
+}
+
+/**
+ * A* over jump points. Each node remembers the set of directions it may be expanded in
+ * (the union over the arrivals with the best distance found so far).
+ */
+std::vector<int> JumpPointSearch::findPath(const GridGraph& g, int start, int goalTile){
+    grid = &g;
+    cols = g.getCols();
+    rows = g.getRows();
+    goal = goalTile;
+    int totalNodes = rows * cols;
+
+    const float INF = std::numeric_limits<float>::infinity();
+    distance.assign(totalNodes, INF);
+    previous.assign(totalNodes, -1);
+    directions.assign(totalNodes, 0);
+    closed.assign(totalNodes, 0);
+    lastStats = SearchStats();
+
+    auto heuristic = [&](int id){
+        return float(std::abs(id / cols - goal / cols) + std::abs(id % cols - goal % cols));
+    };
+
+    typedef std::pair<std::pair<float, float>, int> Entry;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> pq;
+
+    distance[start] = 0.0f;
+    directions[start] = UP | DOWN | LEFT | RIGHT;
+    pq.push({{heuristic(start), heuristic(start)}, start});
+    lastStats.pushed++;
+
+    /// Relaxes the edge u -> v (straight segment) and records the directions v may continue in
+    auto relax = [&](int u, int v, unsigned mask){
+        if(closed[v])
+            return;
+        float d = distance[u] + float(std::abs(u / cols - v / cols) + std::abs(u % cols - v % cols));
+        if(d < distance[v]){
+            distance[v] = d;
+            previous[v] = u;
+            directions[v] = mask;
+            float h = heuristic(v);
+            pq.push({{d + h, h}, v});
+            lastStats.pushed++;
+        }
+        else if(d == distance[v]){
+            directions[v] |= mask;
+        }
+    };
+
+    while(!pq.empty()){
+        int u = pq.top().second;
+        pq.pop();
+        if(closed[u])
+            continue;
+        closed[u] = 1;
+        lastStats.expanded++;
+        if(u == goal)
+            break;
+
+        int r = u / cols;
+        int c = u % cols;
+        unsigned dirs = directions[u];
+
+        /// Vertical jumps: afterwards every direction but going back is natural
+        if(dirs & UP){
+            int y = jumpVertical(c, r, -1);
+            if(y >= 0) relax(u, y * cols + c, UP | LEFT | RIGHT);
+        }
+        if(dirs & DOWN){
+            int y = jumpVertical(c, r, 1);
+            if(y >= 0) relax(u, y * cols + c, DOWN | LEFT | RIGHT);
+        }
+        /// Horizontal jumps: only the same direction is natural, plus the forced vertical turns
+        for(int dx = -1; dx <= 1; dx += 2){
+            if(!(dirs & (dx < 0 ? LEFT : RIGHT)))
+                continue;
+            int x = jumpHorizontal(c, r, dx);
+            if(x < 0)
+                continue;
+            unsigned mask = dx < 0 ? LEFT : RIGHT;
+            if(isFree(x, r - 1) && !isFree(x - dx, r - 1)) mask |= UP;
+            if(isFree(x, r + 1) && !isFree(x - dx, r + 1)) mask |= DOWN;
+            relax(u, r * cols + x, mask);
+        }
+    }
+
+    if(previous[goal] == -1 && goal != start)
+        return {goal};
+
+    /// Collect the jump points from goal to start, then fill the straight segments between them
+    std::vector<int> jumpPoints;
+    for(int at = goal; at != -1; at = previous[at])
+        jumpPoints.push_back(at);
+    std::reverse(jumpPoints.begin(), jumpPoints.end());
+
+    std::vector<int> path;
+    path.push_back(jumpPoints[0]);
+    for(size_t i = 1; i < jumpPoints.size(); i++){
+        int from = jumpPoints[i - 1];
+        int to = jumpPoints[i];
+        int step = (to / cols == from / cols) ? (to > from ? 1 : -1) : (to > from ? cols : -cols);
+        for(int at = from + step; ; at += step){
+            path.push_back(at);
+            if(at == to)
+                break;
+        }
+    }
+    return path;
+}
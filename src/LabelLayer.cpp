@@ -0,0 +1,93 @@
+#include "LabelLayer.h"
+#include <algorithm>
+#include <string>
+
+LabelLayer::LabelLayer(const sf::Font& f, unsigned size, sf::Color c)
+    : font(&f), characterSize(size), color(c), vertices(sf::Triangles) {
+}
+
+void LabelLayer::update(const Map& map){
+    if(map.getCols() != builtCols || map.getRows() != builtRows || map.getTileSize() != builtTileSize)
+        rebuild(map);
+}
+
+/**
+ * Lays out the labels the way sf::Text does (baseline at characterSize, 1 pixel of padding
+ * around each glyph), and centers each one with its local bounds, as the per-frame sf::Text did.
+ */
+void LabelLayer::rebuild(const Map& map){
+    builtCols = map.getCols();
+    builtRows = map.getRows();
+    builtTileSize = map.getTileSize();
+
+    const std::vector<Tile>& tiles = map.getTiles();
+    vertices.clear();
+
+    const float padding = 1.0f;
+    const float baseline = float(characterSize);
+    for(std::size_t i = 0; i < tiles.size(); i++){
+        std::string label = std::to_string(i);
+
+        /// Local bounds of the label
+        float x = 0.0f;
+        float minX = 0.0f, minY = 0.0f, maxX = 0.0f, maxY = 0.0f;
+        bool first = true;
+        sf::Uint32 previous = 0;
+        for(char ch : label){
+            sf::Uint32 code = sf::Uint32(ch);
+            x += font->getKerning(previous, code, characterSize);
+            const sf::Glyph& g = font->getGlyph(code, characterSize, false);
+            float left = x + g.bounds.left;
+            float top = baseline + g.bounds.top;
+            float right = left + g.bounds.width;
+            float bottom = top + g.bounds.height;
+            minX = first ? left : std::min(minX, left);
+            minY = first ? top : std::min(minY, top);
+            maxX = first ? right : std::max(maxX, right);
+            maxY = first ? bottom : std::max(maxY, bottom);
+            first = false;
+            x += g.advance;
+            previous = code;
+        }
+
+        TileBounds tb = tiles[i].getGlobalBounds();
+        float originX = tb.left + (tb.width - (maxX - minX)) / 2.f;
+        float originY = tb.top + (tb.height - (maxY - minY)) / 2.f;
+
+        /// Glyph quads, as two triangles each
+        x = 0.0f;
+        previous = 0;
+        for(char ch : label){
+            sf::Uint32 code = sf::Uint32(ch);
+            x += font->getKerning(previous, code, characterSize);
+            const sf::Glyph& g = font->getGlyph(code, characterSize, false);
+
+            float left = originX + x + g.bounds.left - padding;
+            float top = originY + baseline + g.bounds.top - padding;
+            float right = originX + x + g.bounds.left + g.bounds.width + padding;
+            float bottom = originY + baseline + g.bounds.top + g.bounds.height + padding;
+
+            float u1 = float(g.textureRect.left) - padding;
+            float v1 = float(g.textureRect.top) - padding;
+            float u2 = float(g.textureRect.left + g.textureRect.width) + padding;
+            float v2 = float(g.textureRect.top + g.textureRect.height) + padding;
+
+            vertices.append(sf::Vertex(sf::Vector2f(left, top), color, sf::Vector2f(u1, v1)));
+            vertices.append(sf::Vertex(sf::Vector2f(right, top), color, sf::Vector2f(u2, v1)));
+            vertices.append(sf::Vertex(sf::Vector2f(left, bottom), color, sf::Vector2f(u1, v2)));
+            vertices.append(sf::Vertex(sf::Vector2f(left, bottom), color, sf::Vector2f(u1, v2)));
+            vertices.append(sf::Vertex(sf::Vector2f(right, top), color, sf::Vector2f(u2, v1)));
+            vertices.append(sf::Vertex(sf::Vector2f(right, bottom), color, sf::Vector2f(u2, v2)));
+
+            x += g.advance;
+            previous = code;
+        }
+    }
+}
+
+void LabelLayer::draw(sf::RenderTarget& target, sf::RenderStates states) const {
+    if(!visible)
+        return;
+    states.texture = &font->getTexture(characterSize);
+    target.draw(vertices, states);
+}
@@ -0,0 +1,60 @@
+#include "Landmarks.h"
+#include <algorithm>
+
+void Landmarks::distancesFrom(const GridGraph& grid, int source, int * out){
+    std::fill(out, out + grid.size(), -1);
+    std::vector<int> queue;
+    queue.reserve(grid.size());
+    out[source] = 0;
+    queue.push_back(source);
+    for(std::size_t head = 0; head < queue.size(); head++){
+        int u = queue[head];
+        grid.forEachNeighbor(u, [&](int v, float){
+            if(out[v] < 0){
+                out[v] = out[u] + 1;
+                queue.push_back(v);
+            }
+        });
+    }
+}
+
+/**
+ * Farthest-point selection: the first landmark is the tile farthest from the first free tile,
+ * each following one is the tile farthest from all the landmarks already chosen.
+ * Once the component of the first tile has no tile left at a positive distance, the next
+ * landmark goes to a free tile no landmark reaches (another component).
+ */
+void Landmarks::build(const GridGraph& grid, int count){
+    clear();
+    int first = 0;
+    while(first < grid.size() && grid.isBlocked(first))
+        first++;
+    if(first == grid.size() || count <= 0)
+        return;
+
+    cells = grid.size();
+    std::vector<int> seed(cells);
+    distancesFrom(grid, first, seed.data());
+    /// Distance from each tile to the nearest chosen landmark (seeded with the first free tile)
+    std::vector<int> nearest = seed;
+
+    distances.reserve(std::size_t(count) * cells);
+    for(int k = 0; k < count; k++){
+        int best = -1;
+        for(int t = 0; t < cells; t++)
+            if(nearest[t] > 0 && (best < 0 || nearest[t] > nearest[best]))
+                best = t;
+        for(int t = 0; best < 0 && t < cells; t++)
+            if(nearest[t] < 0 && !grid.isBlocked(t))
+                best = t;
+        if(best < 0)
+            break;
+        landmarks.push_back(best);
+        distances.resize(std::size_t(k + 1) * cells);
+        int * d = &distances[std::size_t(k) * cells];
+        distancesFrom(grid, best, d);
+        for(int t = 0; t < cells; t++)
+            if(d[t] >= 0 && (nearest[t] < 0 || d[t] < nearest[t]))
+                nearest[t] = d[t];
+    }
+}
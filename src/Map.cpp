@@ -1,5 +1,7 @@
 #include "Map.h"
+#include "NodeArray.h"
 #include <queue>
+#include <algorithm>
 /**
  * Main constructor. Initializes the grid based on the window dimensions.
  * Each tile is created as an "Empty" (white) tile.
@@ -15,16 +17,58 @@ Map::Map(int const windowsWidth, int const windowHeight){
         for(int c = 0; c < cols; c++){
             /// Generete a rect in the right position 
             Tile t(tilesSize-1, tilesSize-1, tilesSize); ///-1 to visually separate tiles
-            t.setFillColor(sf::Color::White);
+            t.setFillColor(Color::White);
             t.setPosition(c*tilesSize, r*tilesSize);
             tiles.push_back(t);
         }
     }
+    grid.resize(cols, rows);
+    dirtyFlags.assign(tiles.size(), 0);
+}
+
+/**
+ * Builds a map of gridCols x gridRows tiles, as if the window was exactly that many tiles wide.
+ * Used by the headless runner, which has no window to derive the size from.
+ */
+Map Map::fromGrid(int gridCols, int gridRows){
+    Map m;
+    return Map(gridCols * m.tilesSize, gridRows * m.tilesSize);
+}
+
+/**
+ * Wraps an occupancy grid without creating any tile.
+ */
+Map Map::fromOccupancy(const GridGraph& occupancy, int tileSize){
+    Map m;
+    m.tilesSize = tileSize;
+    m.cols = occupancy.getCols();
+    m.rows = occupancy.getRows();
+    m.grid = occupancy;
+    return m;
+}
+
+/**
+ * Builds one tile per cell, typed after the occupancy (Obstacle or Empty).
+ */
+void Map::createTiles(){
+    if(hasTiles())
+        return;
+    tiles.reserve(std::size_t(rows) * cols);
+    for(int r = 0; r < rows; r++){
+        for(int c = 0; c < cols; c++){
+            Tile t(tilesSize-1, tilesSize-1, tilesSize);
+            t.setPosition(c*tilesSize, r*tilesSize);
+            t.setType(grid.isBlocked(r * cols + c) ? TileType::Obstacle : TileType::Empty);
+            tiles.push_back(t);
+        }
+    }
+    dirtyFlags.assign(tiles.size(), 0);
 }
 
 /**
  * Clones the map structure without obstacles. All tiles are set to Empty.
  * Useful for algorithmic purposes (e.g., simulated pathfinding) without modifying the real map.
+ * The clone of a tile-less map has a chunked occupancy grid (see GridGraph::resizeChunked).
  * 
  * @return A new Map object with the same layout but no obstacles.
  */
@@ -33,6 +77,12 @@ Map Map::cloneStructureWithoutObstacles() const {
     clone.tilesSize = this->tilesSize;
     clone.rows = this->rows;
     clone.cols = this->cols;
+    /// A tile-less map is a large world: its blank copy (a robot's belief) only allocates where obstacles appear
+    if(!hasTiles())
+        return cloneBelief();
+    /// Terrain costs are part of the structure: the robot knows them, only the obstacles are discovered
+    clone.costs = costs;
+    clone.grid.resize(cols, rows);
 
     for (int r = 0; r < rows; r++) {
         for (int c = 0; c < cols; c++) {
@@ -43,18 +93,78 @@ Map Map::cloneStructureWithoutObstacles() const {
             clone.tiles.push_back(t);
         }
     }
+    clone.dirtyFlags.assign(clone.tiles.size(), 0);
 
     return clone;
 }
 
 
 
-std::vector<Tile>& Map::getTiles()  {
+/**
+ * A grid within one page keeps the dense layout: a page, its block and the planners' 64x64 chunks
+ * would cost more than the whole map (a dense grid reads every tile as free, as the planners read unknown).
+ */
+Map Map::cloneBelief() const {
+    Map belief;
+    belief.tilesSize = tilesSize;
+    belief.rows = rows;
+    belief.cols = cols;
+    belief.costs = costs;
+    if(cols <= BeliefGrid::PAGE && rows <= BeliefGrid::PAGE)
+        belief.grid.resize(cols, rows);
+    else
+        belief.grid.resizeChunked(cols, rows);
+    return belief;
+}
+
+const std::vector<Tile>& Map::getTiles() const {
     return tiles;
 }
 
+void Map::setTileType(int id, TileType type){
+    bool blocked = type == TileType::Obstacle;
+    if(grid.isBlocked(id) != blocked){
+        version++; /// Cached paths of older versions no longer match
+        /// A removed obstacle can shorten distances: the landmark bounds may overestimate
+        if(!blocked)
+            landmarks.clear();
+        grid.setBlocked(id, blocked);
+    }
+    if(!hasTiles())
+        return;
+    tiles[id].setType(type);
+    markDirty(id);
+}
+
+void Map::setCellState(int id, CellState s){
+    bool blocked = s == CellState::Blocked;
+    if(grid.isBlocked(id) != blocked)
+        setTileType(id, blocked ? TileType::Obstacle : TileType::Empty);
+    grid.setCellState(id, s);
+}
+
+void Map::setTileFillColor(int id, Color c){
+    if(!hasTiles())
+        return;
+    tiles[id].setFillColor(c);
+    markDirty(id);
+}
+
+void Map::markDirty(int id){
+    if(!dirtyFlags[id]){
+        dirtyFlags[id] = 1;
+        dirtyTiles.push_back(id);
+    }
+}
+
+void Map::clearDirtyTiles(){
+    for(int id : dirtyTiles)
+        dirtyFlags[id] = 0;
+    dirtyTiles.clear();
+}
+
 /**
- * Builds the adjacency list graph for pathfinding. 
+ * Builds the adjacency list graph from the implicit grid graph.
  * Only non-obstacles tiles are connected to their valid neighbors. 
  */
 void Map::buildGraph(){
@@ -62,37 +172,11 @@ void Map::buildGraph(){
     graph.clear();
     graph.resize(totalNodes); 
 
-    for(int r=0; r<rows; r++){
-        for(int c=0; c<cols; c++){
-            int nodeID= r*cols + c; 
-
-            /// Skip if the current tile is an obstacle
-            if(tiles[nodeID].getType() == TileType::Obstacle)
-                continue;
-
-            /// Check adjacent nodes (up, down, left, right)
-            if (r > 0){
-                int upNodeID = (r-1)*cols+c; 
-                if(tiles[upNodeID].getType() != TileType::Obstacle)
-                    graph[nodeID].emplace_back(upNodeID, 1.0f);
-            }
-            if (r < rows - 1){
-                int downNodeID = (r + 1) * cols + c;
-                if(tiles[downNodeID].getType() != TileType::Obstacle)
-                    graph[nodeID].emplace_back(downNodeID, 1.0f);
-            }
-            if(c>0){
-                int leftNodeID = r * cols + (c - 1);
-                if(tiles[leftNodeID].getType() != TileType::Obstacle)
-                    graph[nodeID].emplace_back(leftNodeID, 1.0f);
-            }
-            if (c < cols - 1) {
-                int rightNodeID = r * cols + (c + 1);
-                if(tiles[rightNodeID].getType() != TileType::Obstacle)
-                    graph[nodeID].emplace_back(rightNodeID, 1.0f);
-            }
-        }
-    }   
+    for(int nodeID = 0; nodeID < totalNodes; nodeID++){
+        grid.forEachNeighbor(nodeID, [&](int v, float){
+            graph[nodeID].emplace_back(v, float(costs.get(v)));
+        });
+    }
 }
 
 const std::vector<std::vector<std::pair<int,float>>>& Map::getGraph() const{
@@ -112,16 +196,6 @@ void Map::printGraph() const {
     }
 }
 
-/**
- * Draws all the tiles on the provided SFML window.
- * @param window The SFML window to render to
- */
-void Map::draw(sf::RenderWindow& window) const {
-    for (const auto& tile : tiles) {
-        tile.draw(window);  /// Il metodo draw di Tile
-    }
-}
-
 
 /**
  * Dijkstra's algorithm for shortest path between two nodes.
@@ -130,54 +204,271 @@ void Map::draw(sf::RenderWindow& window) const {
  * @return A vector of tile indices representing the shortest path.
  */
 std::vector<int> Map::dijkstra(int start, int goal){
-    int totalNodes = graph.size();
+    std::vector<int> path;
+    if(lookupPath(start, goal, path))
+        return path;
+
+    /// Per-tile state, chunked on a chunked grid (see NodeArray)
+    bool chunked = grid.isChunked();
     /// Vector of distances 
-    std::vector<float> distance (totalNodes, std::numeric_limits<float>::infinity());
+    NodeArray<float> distance;
+    distance.assign(cols, rows, std::numeric_limits<float>::infinity(), chunked);
 
     /// Vector of previous
-    std::vector<int> previous(totalNodes, -1);
+    NodeArray<int> previous;
+    previous.assign(cols, rows, -1, chunked);
 
     distance[start]=0.0f;
+    lastSearchStats = SearchStats();
 
     /// Priority queue 
     std::priority_queue<std::pair<float, int>,
                     std::vector<std::pair<float, int>>,
                     std::greater<std::pair<float, int>>> pq;
     pq.emplace(0.0f, start);
+    lastSearchStats.pushed++;
 
     /// Algorithm: 
     while(!pq.empty()){
         /// Get the element with the shortest distance: 
-        auto [dist, u] = pq.top(); 
+        int u = pq.top().second; 
         pq.pop();
+        lastSearchStats.expanded++;
 
         /// Get the neighbor of u and check the distances
-        for(auto [v, weight] : graph[u]){
+        grid.forEachNeighbor(u, [&](int v, float){
+            float weight = costs.get(v);
             if(distance[u] + weight < distance[v]){
                 distance[v] = distance[u]+weight; 
                 previous[v] = u; 
                 pq.emplace(distance[v], v);
+                lastSearchStats.pushed++;
             }
-        }
+        });
     }
 
     /// Reconstruct path from goal to start
-    std::vector<int> path; 
     for(int at = goal; at!=-1; at = previous[at]){
         path.push_back(at);
     }
     std::reverse(path.begin(), path.end());
 
+    pathCache.put(start, goal, version, path);
     return path; 
 }
 
+/**
+ * A* search for the shortest path between two nodes.
+ * Nodes are settled in order of f = g + h (ties broken towards the goal, smaller h first);
+ * a node popped a second time is a stale entry and is skipped.
+ * @param start ID of the start tile.
+ * @param goal ID of the goal tile.
+ * @param h Admissible heuristic, h(node) estimates the distance from node to goal.
+ * @return A vector of tile indices representing the shortest path.
+ */
+template<typename H>
+std::vector<int> Map::aStarSearch(int start, int goal, H h){
+    bool chunked = grid.isChunked();
+    NodeArray<float> distance;
+    distance.assign(cols, rows, std::numeric_limits<float>::infinity(), chunked);
+    NodeArray<int> previous;
+    previous.assign(cols, rows, -1, chunked);
+    NodeArray<char> closed;
+    closed.assign(cols, rows, 0, chunked);
+
+    distance[start]=0.0f;
+    lastSearchStats = SearchStats();
+
+    /// Queue entries: ((f, h), node)
+    typedef std::pair<std::pair<float, float>, int> Entry;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> pq;
+    float hStart = h(start);
+    pq.push({{hStart, hStart}, start});
+    lastSearchStats.pushed++;
+
+    while(!pq.empty()){
+        int u = pq.top().second;
+        pq.pop();
+
+        /// Stale entry: u was already settled with a smaller f
+        if(closed[u])
+            continue;
+        closed[u] = 1;
+        lastSearchStats.expanded++;
+
+        /// Goal settled: its distance is final
+        if(u == goal)
+            break;
+
+        grid.forEachNeighbor(u, [&](int v, float){
+            if(closed[v])
+                return;
+            float newDistance = distance[u] + costs.get(v);
+            if(newDistance < distance[v]){
+                distance[v] = newDistance;
+                previous[v] = u;
+                float hv = h(v);
+                pq.push({{newDistance + hv, hv}, v});
+                lastSearchStats.pushed++;
+            }
+        });
+    }
+
+    /// Reconstruct path from goal to start
+    std::vector<int> path;
+    for(int at = goal; at!=-1; at = previous[at]){
+        path.push_back(at);
+    }
+    std::reverse(path.begin(), path.end());
+
+    return path;
+}
+
+/**
+ * Dijkstra with integer distances on a BucketQueue. Edge costs are at most CostLayer::MAX_COST,
+ * below BucketQueue::SPAN, so every key pushed stays within the window of the queue.
+ * An entry whose key is larger than the node's distance is stale and skipped.
+ */
+std::vector<int> Map::dial(int start, int goal){
+    std::vector<int> path;
+    if(lookupPath(start, goal, path))
+        return path;
+
+    const unsigned INF = std::numeric_limits<unsigned>::max();
+    bool chunked = grid.isChunked();
+    NodeArray<unsigned> distance;
+    distance.assign(cols, rows, INF, chunked);
+    NodeArray<int> previous;
+    previous.assign(cols, rows, -1, chunked);
+
+    distance[start] = 0;
+    lastSearchStats = SearchStats();
+    buckets.clear();
+    buckets.push(0, start);
+    lastSearchStats.pushed++;
+
+    while(!buckets.empty()){
+        unsigned key;
+        int u = buckets.pop(key);
+        if(key != distance.get(u))
+            continue;
+        lastSearchStats.expanded++;
+        if(u == goal)
+            break;
+
+        grid.forEachNeighbor(u, [&](int v, float){
+            unsigned newDistance = key + costs.get(v);
+            if(newDistance < distance.get(v)){
+                distance[v] = newDistance;
+                previous[v] = u;
+                buckets.push(newDistance, v);
+                lastSearchStats.pushed++;
+            }
+        });
+    }
+
+    /// Reconstruct path from goal to start
+    for(int at = goal; at!=-1; at = previous.get(at)){
+        path.push_back(at);
+    }
+    std::reverse(path.begin(), path.end());
+
+    pathCache.put(start, goal, version, path);
+    return path;
+}
+
+bool Map::lookupPath(int start, int goal, std::vector<int>& path){
+    const std::vector<int> * cached = pathCache.get(start, goal, version);
+    if(!cached)
+        return false;
+    path = *cached;
+    lastSearchStats = SearchStats();
+    return true;
+}
+
+std::vector<int> Map::aStar(int start, int goal, Heuristic h){
+    std::vector<int> path;
+    if(lookupPath(start, goal, path))
+        return path;
+    path = aStarSearch(start, goal, [&](int v){return h(v, goal, cols);});
+    pathCache.put(start, goal, version, path);
+    return path;
+}
+
+std::vector<int> Map::aStarLandmarks(int start, int goal){
+    std::vector<int> path;
+    if(lookupPath(start, goal, path))
+        return path;
+    path = aStarSearch(start, goal, [&](int v){
+        return std::max(landmarks.heuristic(v, goal), manhattanHeuristic(v, goal, cols));
+    });
+    pathCache.put(start, goal, version, path);
+    return path;
+}
+
+void Map::setTileCost(int id, std::uint8_t cost){
+    if(costs.get(id) == (cost ? cost : 1))
+        return;
+    costs.set(cols, rows, id, cost);
+    version++;
+}
+
+void Map::setCosts(const CostLayer& layer){
+    costs = layer;
+    version++;
+}
+
+/**
+ * Breadth-first search from every obstacle at once gives each free tile its distance (in steps)
+ * to the closest obstacle, up to radius.
+ */
+void Map::addObstaclePenalty(int radius, int penalty){
+    if(radius <= 0 || penalty <= 0)
+        return;
+    std::vector<int> distance(std::size_t(cols) * rows, -1);
+    std::vector<int> queue;
+    for(int i = 0; i < cols * rows; i++){
+        if(grid.isBlocked(i)){
+            distance[i] = 0;
+            queue.push_back(i);
+        }
+    }
+    for(std::size_t head = 0; head < queue.size(); head++){
+        int u = queue[head];
+        if(distance[u] >= radius)
+            continue;
+        int r = u / cols;
+        int c = u % cols;
+        int next[4] = {r > 0 ? u - cols : -1, r < rows - 1 ? u + cols : -1, c > 0 ? u - 1 : -1, c < cols - 1 ? u + 1 : -1};
+        for(int v : next){
+            if(v < 0 || distance[v] >= 0)
+                continue;
+            distance[v] = distance[u] + 1;
+            queue.push_back(v);
+            int cost = costs.get(v) + penalty * (radius + 1 - distance[v]);
+            costs.set(cols, rows, v, std::uint8_t(std::min(cost, CostLayer::MAX_COST)));
+        }
+    }
+    version++;
+}
+
+/**
+ * Runs farthest-point landmark selection and the distance tables on the current occupancy.
+ */
+void Map::preprocessLandmarks(int count){
+    landmarks.build(grid, count);
+}
+
 /**
  *  Changes the border color of a specific tile.
  * @param c The new outline color.
  * @param id The tile index.
  */
-void Map::setBorderColorTile(sf::Color c, int id){
+void Map::setBorderColorTile(Color c, int id){
+    if(!hasTiles())
+        return;
     tiles[id].setBorderColor(c);
+    markDirty(id);
 }
 
 /**
@@ -186,10 +477,13 @@ void Map::setBorderColorTile(sf::Color c, int id){
  * @param p The path as a list of tile indices.
  */
 void Map::defaultColorTile(std::vector<int> p){
+    if(!hasTiles())
+        return;
     for(int i=0; i<p.size(); i++){
         if(i==0 || i==p.size()-1 || tiles[p[i]].getType()==TileType::Obstacle)
             continue;
-        tiles[p[i]].setFillColor(sf::Color::White);
+        tiles[p[i]].setFillColor(Color::White);
+        markDirty(p[i]);
     }
 }
 
@@ -199,10 +493,13 @@ void Map::defaultColorTile(std::vector<int> p){
  * @param p The path as a list of tile indices.
  */
 void Map::setColorPath(std::vector<int> p){
+    if(!hasTiles())
+        return;
     for(int i=0; i<p.size(); i++){
         if(i==0 || i==p.size()-1 || tiles[p[i]].getType()==TileType::Obstacle)
             continue;
-        tiles[p[i]].setFillColor(sf::Color(255, 0, 0, 150));  /// semi-transparent red
+        tiles[p[i]].setFillColor(Color(255, 0, 0, 150));  /// semi-transparent red
+        markDirty(p[i]);
 
     }
 }
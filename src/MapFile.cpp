@@ -0,0 +1,241 @@
+#include "MapFile.h"
+#include "Map.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const char MAGIC[4] = {'R', 'S', 'M', 'P'};
+
+/**
+ * Read-only mapping of a whole file, unmapped when the last grid viewing it goes away.
+ */
+struct Mapping {
+    void * address = MAP_FAILED;
+    std::size_t length = 0;
+    ~Mapping(){
+        if(address != MAP_FAILED)
+            munmap(address, length);
+    }
+};
+
+/**
+ * Skips whitespace and '#' comments in a PGM header, then reads a number.
+ */
+bool readPgmNumber(std::istream& in, long& value){
+    int ch;
+    while((ch = in.peek()) != EOF){
+        if(ch == '#')
+            while((ch = in.get()) != EOF && ch != '\n');
+        else if(std::isspace(ch))
+            in.get();
+        else
+            break;
+    }
+    return bool(in >> value);
+}
+
+}
+
+bool MapFile::open(const std::string& path){
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0){
+        std::cerr << "Cannot open map file " << path << "\n";
+        return false;
+    }
+    struct stat st;
+    if(fstat(fd, &st) != 0 || std::size_t(st.st_size) < sizeof(MapFileHeader)){
+        std::cerr << "Map file " << path << " is too small\n";
+        ::close(fd);
+        return false;
+    }
+
+    auto m = std::make_shared<Mapping>();
+    m->length = std::size_t(st.st_size);
+    m->address = mmap(nullptr, m->length, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if(m->address == MAP_FAILED){
+        std::cerr << "Cannot map " << path << "\n";
+        return false;
+    }
+
+    MapFileHeader h;
+    std::memcpy(&h, m->address, sizeof(h));
+    std::uint64_t occupancyBytes = std::uint64_t(h.wordsPerRow) * h.rows * 8;
+    std::uint64_t costBytes = std::uint64_t(h.cols) * h.rows * h.costLayers;
+    /// Written so that a crafted offset cannot wrap around past the end of the file
+    auto fits = [&](std::uint64_t offset, std::uint64_t bytes){
+        return offset <= m->length && bytes <= m->length - offset;
+    };
+    bool valid = std::memcmp(h.magic, MAGIC, 4) == 0 && h.version == VERSION
+              && h.cols > 0 && h.rows > 0 && std::uint64_t(h.cols) * h.rows <= 0x7fffffffu
+              && h.tileSize > 0 && h.tileSize <= 0x7fffffffu
+              && h.wordsPerRow == (h.cols + 63) / 64
+              && h.occupancyOffset % 8 == 0 && fits(h.occupancyOffset, occupancyBytes)
+              && (h.costLayers == 0 || fits(h.costOffset, costBytes));
+    if(!valid){
+        std::cerr << path << " is not a valid map file (version " << VERSION << ")\n";
+        return false;
+    }
+
+    /// Hint the kernel: planners touch the bits in no particular order
+    madvise(m->address, m->length, MADV_RANDOM);
+
+    header = h;
+    base = static_cast<const std::uint8_t*>(m->address);
+    occupancy.attach(int(h.cols), int(h.rows),
+                     reinterpret_cast<const std::uint64_t*>(base + h.occupancyOffset), m);
+    mapping = m;
+    return true;
+}
+
+Map MapFile::toMap() const {
+    Map m = Map::fromOccupancy(occupancy, getTileSize());
+    if(getCostLayerCount() > 0){
+        CostLayer costs;
+        costs.attach(getCols(), getRows(), getCostLayer(0), mapping);
+        m.setCosts(costs);
+    }
+    return m;
+}
+
+const std::uint8_t * MapFile::getCostLayer(int i) const {
+    if(!isOpen() || i < 0 || i >= getCostLayerCount())
+        return nullptr;
+    return base + header.costOffset + std::uint64_t(i) * header.cols * header.rows;
+}
+
+bool MapFile::save(const std::string& path, const Map& map,
+                   const std::vector<std::vector<std::uint8_t>>& costLayers){
+    const GridGraph& grid = map.getGrid();
+    std::size_t cells = std::size_t(grid.getCols()) * grid.getRows();
+    /// The map's own costs, if any, are layer 0 (the one toMap reads back)
+    std::vector<std::vector<std::uint8_t>> mapCosts;
+    if(costLayers.empty() && !map.getCosts().isUniform()){
+        mapCosts.resize(1);
+        map.getCosts().copyTo(mapCosts[0], grid.getCols(), grid.getRows());
+    }
+    const std::vector<std::vector<std::uint8_t>>& layers = costLayers.empty() ? mapCosts : costLayers;
+    for(const auto& layer : layers){
+        if(layer.size() != cells){
+            std::cerr << "Cost layer size does not match the map\n";
+            return false;
+        }
+    }
+
+    MapFileHeader h{};
+    std::memcpy(h.magic, MAGIC, 4);
+    h.version = VERSION;
+    h.cols = std::uint32_t(grid.getCols());
+    h.rows = std::uint32_t(grid.getRows());
+    h.tileSize = std::uint32_t(map.getTileSize());
+    h.wordsPerRow = std::uint32_t(grid.getWordsPerRow());
+    h.costLayers = std::uint32_t(layers.size());
+    h.occupancyOffset = sizeof(MapFileHeader);
+    std::uint64_t occupancyBytes = std::uint64_t(h.wordsPerRow) * h.rows * 8;
+    h.costOffset = layers.empty() ? 0 : h.occupancyOffset + occupancyBytes;
+
+    std::ofstream out(path, std::ios::binary);
+    if(!out){
+        std::cerr << "Cannot write map file " << path << "\n";
+        return false;
+    }
+    out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    std::vector<std::uint64_t> words(std::size_t(occupancyBytes / 8));
+    grid.copyWords(words.data());
+    out.write(reinterpret_cast<const char*>(words.data()), std::streamsize(occupancyBytes));
+    for(const auto& layer : layers)
+        out.write(reinterpret_cast<const char*>(layer.data()), std::streamsize(layer.size()));
+    if(!out){
+        std::cerr << "Error while writing " << path << "\n";
+        return false;
+    }
+    return true;
+}
+
+bool MapFile::importText(const std::string& path, GridGraph& out){
+    std::ifstream in(path);
+    if(!in){
+        std::cerr << "Cannot open " << path << "\n";
+        return false;
+    }
+    std::vector<std::string> lines;
+    std::string line;
+    std::size_t cols = 0;
+    while(std::getline(in, line)){
+        if(!line.empty() && line.back() == '\r')
+            line.pop_back();
+        cols = std::max(cols, line.size());
+        lines.push_back(line);
+    }
+    /// Trailing empty lines are not rows
+    while(!lines.empty() && lines.back().empty())
+        lines.pop_back();
+    if(lines.empty() || cols == 0){
+        std::cerr << path << " contains no map\n";
+        return false;
+    }
+
+    out.resize(int(cols), int(lines.size()));
+    for(std::size_t r = 0; r < lines.size(); r++){
+        for(std::size_t c = 0; c < lines[r].size(); c++){
+            char ch = lines[r][c];
+            if(ch == '#' || ch == 'X' || ch == '@' || ch == '1')
+                out.setBlocked(int(r * cols + c), true);
+        }
+    }
+    return true;
+}
+
+bool MapFile::importPGM(const std::string& path, GridGraph& out, int threshold){
+    std::ifstream in(path, std::ios::binary);
+    char magic[2] = {0, 0};
+    if(!in.read(magic, 2) || magic[0] != 'P' || (magic[1] != '2' && magic[1] != '5')){
+        std::cerr << path << " is not a PGM image\n";
+        return false;
+    }
+    long width, height, maxValue;
+    if(!readPgmNumber(in, width) || !readPgmNumber(in, height) || !readPgmNumber(in, maxValue)
+       || width <= 0 || height <= 0 || width * height > 0x7fffffffL || maxValue <= 0 || maxValue > 65535){
+        std::cerr << "Bad PGM header in " << path << "\n";
+        return false;
+    }
+
+    bool binary = magic[1] == '5';
+    bool wide = maxValue > 255;
+    long limit = long(threshold) * maxValue / 255;
+    if(binary)
+        in.get(); /// Single whitespace after the header
+
+    out.resize(int(width), int(height));
+    std::vector<unsigned char> row(std::size_t(width) * (wide ? 2 : 1));
+    for(long r = 0; r < height; r++){
+        if(binary && !in.read(reinterpret_cast<char*>(row.data()), std::streamsize(row.size()))){
+            std::cerr << path << " is truncated\n";
+            return false;
+        }
+        for(long c = 0; c < width; c++){
+            long value;
+            if(!binary){
+                if(!(in >> value)){
+                    std::cerr << path << " is truncated\n";
+                    return false;
+                }
+            }
+            else if(wide)
+                value = (long(row[2*c]) << 8) | row[2*c + 1]; /// 16-bit samples are big endian
+            else
+                value = row[c];
+            if(value < limit)
+                out.setBlocked(int(r * width + c), true);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,127 @@
+#include "Metrics.h"
+#include <cmath>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+/// Atomic a = f(a, v) for doubles (no fetch_add/min/max on atomic<double> before C++20)
+template<typename F>
+void update(std::atomic<double>& a, double v, F f){
+    double current = a.load(std::memory_order_relaxed);
+    double next = f(current, v);
+    while(next != current && !a.compare_exchange_weak(current, next, std::memory_order_relaxed))
+        next = f(current, v);
+}
+
+/// Escapes the characters that cannot appear as such in a JSON string
+std::string jsonString(const std::string& s){
+    std::string out = "\"";
+    for(char c : s){
+        if(c == '"' || c == '\\')
+            out += '\\';
+        out += c;
+    }
+    return out + "\"";
+}
+
+}
+
+void Histogram::record(double v){
+    if(v < 0)
+        v = 0;
+    /// Bucket 0 holds [0, 1), bucket b holds [2^(b-1), 2^b)
+    int b = v < 1.0 ? 0 : std::ilogb(v) + 1;
+    if(b >= BUCKETS)
+        b = BUCKETS - 1;
+    buckets[b].fetch_add(1, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+    update(sum, v, [](double a, double x){return a + x;});
+    update(minValue, v, [](double a, double x){return x < a ? x : a;});
+    update(maxValue, v, [](double a, double x){return x > a ? x : a;});
+}
+
+double Histogram::percentile(double p) const {
+    long n = getCount();
+    if(n == 0)
+        return 0.0;
+    long rank = long(std::ceil(p * n));
+    if(rank < 1)
+        rank = 1;
+    long seen = 0;
+    for(int b = 0; b < BUCKETS; b++){
+        seen += buckets[b].load(std::memory_order_relaxed);
+        if(seen >= rank){
+            double upper = std::ldexp(1.0, b);
+            return upper < getMax() ? upper : getMax();
+        }
+    }
+    return getMax();
+}
+
+Counter& MetricsRegistry::counter(const std::string& name, const std::string& label){
+    std::lock_guard<std::mutex> lock(mutex);
+    std::unique_ptr<Counter>& c = counters[Key(name, label)];
+    if(!c)
+        c = std::make_unique<Counter>();
+    return *c;
+}
+
+Histogram& MetricsRegistry::histogram(const std::string& name, const std::string& label){
+    std::lock_guard<std::mutex> lock(mutex);
+    std::unique_ptr<Histogram>& h = histograms[Key(name, label)];
+    if(!h)
+        h = std::make_unique<Histogram>();
+    return *h;
+}
+
+void MetricsRegistry::writeCsv(std::ostream& out, long tick, bool header) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    if(header)
+        out << "tick,type,name,label,count,sum,min,max,mean,p50,p90,p99\n";
+    for(const auto& c : counters)
+        out << tick << ",counter," << c.first.first << "," << c.first.second << "," << c.second->get() << ",,,,,,,\n";
+    for(const auto& h : histograms){
+        const Histogram& v = *h.second;
+        out << tick << ",histogram," << h.first.first << "," << h.first.second << "," << v.getCount() << ","
+            << v.getSum() << "," << v.getMin() << "," << v.getMax() << "," << v.getMean() << ","
+            << v.percentile(0.5) << "," << v.percentile(0.9) << "," << v.percentile(0.99) << "\n";
+    }
+}
+
+void MetricsRegistry::writeJson(std::ostream& out, long tick) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    out << "{\"tick\": " << tick << ", \"counters\": [";
+    bool first = true;
+    for(const auto& c : counters){
+        out << (first ? "" : ", ") << "{\"name\": " << jsonString(c.first.first)
+            << ", \"label\": " << jsonString(c.first.second) << ", \"value\": " << c.second->get() << "}";
+        first = false;
+    }
+    out << "], \"histograms\": [";
+    first = true;
+    for(const auto& h : histograms){
+        const Histogram& v = *h.second;
+        out << (first ? "" : ", ") << "{\"name\": " << jsonString(h.first.first)
+            << ", \"label\": " << jsonString(h.first.second) << ", \"count\": " << v.getCount()
+            << ", \"sum\": " << v.getSum() << ", \"min\": " << v.getMin() << ", \"max\": " << v.getMax()
+            << ", \"mean\": " << v.getMean() << ", \"p50\": " << v.percentile(0.5)
+            << ", \"p90\": " << v.percentile(0.9) << ", \"p99\": " << v.percentile(0.99) << "}";
+        first = false;
+    }
+    out << "]}\n";
+}
+
+bool MetricsRegistry::dump(const std::string& path, long tick, bool append) const {
+    std::ofstream out(path, append ? std::ios::app : std::ios::trunc);
+    if(!out){
+        std::cerr << "Cannot write metrics to " << path << "\n";
+        return false;
+    }
+    bool csv = path.size() > 4 && path.compare(path.size() - 4, 4, ".csv") == 0;
+    if(csv)
+        writeCsv(out, tick, !append);
+    else
+        writeJson(out, tick);
+    return true;
+}
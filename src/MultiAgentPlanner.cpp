@@ -0,0 +1,604 @@
+#include "MultiAgentPlanner.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <numeric>
+#include <queue>
+
+/// ------------------------ SpaceTimeHash ------------------------
+
+void SpaceTimeHash::clear(){
+    if(count == 0)
+        return;
+    std::fill(keys.begin(), keys.end(), EMPTY);
+    count = 0;
+}
+
+void SpaceTimeHash::grow(){
+    std::vector<std::uint64_t> oldKeys = std::move(keys);
+    std::vector<int> oldValues = std::move(values);
+    std::size_t capacity = oldKeys.empty() ? 64 : oldKeys.size() * 2;
+    keys.assign(capacity, EMPTY);
+    values.assign(capacity, 0);
+    mask = capacity - 1;
+    for(std::size_t i = 0; i < oldKeys.size(); i++){
+        if(oldKeys[i] == EMPTY)
+            continue;
+        std::size_t j = slot(oldKeys[i]);
+        while(keys[j] != EMPTY)
+            j = (j + 1) & mask;
+        keys[j] = oldKeys[i];
+        values[j] = oldValues[i];
+    }
+}
+
+/**
+ * The table is kept at most half full, so probes stay short.
+ */
+int& SpaceTimeHash::at(std::uint64_t key, int initial){
+    if((count + 1) * 2 > keys.size())
+        grow();
+    std::size_t i = slot(key);
+    while(keys[i] != EMPTY){
+        if(keys[i] == key)
+            return values[i];
+        i = (i + 1) & mask;
+    }
+    keys[i] = key;
+    values[i] = initial;
+    count++;
+    return values[i];
+}
+
+/// ------------------------ ReservationTable ------------------------
+
+void ReservationTable::reset(int gridCols){
+    cols = gridCols;
+    clear();
+}
+
+void ReservationTable::clear(){
+    vertices.clear();
+    moves.clear();
+    parked.clear();
+    lastHeld.clear();
+}
+
+/**
+ * A move is keyed by its start tile and direction (0-3 for up, down, left, right, 4 for a wait).
+ */
+std::uint64_t ReservationTable::moveKey(int from, int to, int t) const {
+    int d = to - from;
+    int direction = d == -cols ? 0 : d == cols ? 1 : d == -1 ? 2 : d == 1 ? 3 : 4;
+    return (std::uint64_t(t) << 35) | (std::uint64_t(from) * 5 + direction);
+}
+
+void ReservationTable::reserve(int tile, int t, int agent){
+    vertices.at(vertexKey(tile, t), agent) = agent;
+    int& last = lastHeld.at(std::uint64_t(tile), t);
+    last = std::max(last, t);
+}
+
+void ReservationTable::forbidMove(int from, int to, int t, int agent){
+    moves.at(moveKey(from, to, t), agent) = agent;
+}
+
+void ReservationTable::park(int tile, int t, int agent){
+    (void)agent;
+    int& since = parked.at(std::uint64_t(tile), t);
+    since = std::min(since, t);
+}
+
+int ReservationTable::parkedSince(int tile) const {
+    return parked.find(std::uint64_t(tile), INT_MAX);
+}
+
+bool ReservationTable::canMove(int from, int to, int t) const {
+    if(holder(to, t + 1) >= 0 || parkedSince(to) <= t + 1)
+        return false;
+    return moves.find(moveKey(from, to, t)) < 0;
+}
+
+void ReservationTable::reservePath(const std::vector<int>& path, int agent){
+    int last = int(path.size()) - 1;
+    for(int t = 0; t <= last; t++)
+        reserve(path[t], t, agent);
+    for(int t = 0; t < last; t++)
+        if(path[t] != path[t + 1])
+            forbidMove(path[t + 1], path[t], t, agent); /// No swap with this move
+    park(path[last], last, agent);
+}
+
+bool ReservationTable::admits(const std::vector<int>& path) const {
+    int last = int(path.size()) - 1;
+    if(holder(path[0], 0) >= 0 || parkedSince(path[0]) <= 0)
+        return false;
+    for(int t = 0; t < last; t++)
+        if(!canMove(path[t], path[t + 1], t))
+            return false;
+    /// The agent stays on its last tile: nobody may come there afterwards
+    return getLastHeld(path[last]) < last && parkedSince(path[last]) == INT_MAX;
+}
+
+/// ------------------------ MultiAgentPlanner ------------------------
+
+/**
+ * Scratch buffers of one low-level search. Open entries are ordered by f, then by deepest step
+ * (the search dives towards the goal among equal estimates).
+ */
+struct MultiAgentPlanner::Search {
+    struct Node {
+        int tile;
+        int t;
+        int parent;
+    };
+    struct Entry {
+        int f;
+        int t;
+        int node;
+    };
+    /// Heap order: true if a is popped after b
+    static bool later(const Entry& a, const Entry& b){
+        return a.f > b.f || (a.f == b.f && a.t < b.t);
+    }
+    std::vector<Node> nodes;
+    std::vector<Entry> open;
+    SpaceTimeHash seen; /// (tile, t) states already pushed (g is t, so the first push is the best)
+    std::vector<int> queue; /// BFS of the distance fields
+};
+
+MultiAgentPlanner::MultiAgentPlanner() = default;
+
+MultiAgentPlanner::MultiAgentPlanner(const GridGraph * g, WorkerPool * workers){
+    setGrid(g, workers);
+}
+
+MultiAgentPlanner::~MultiAgentPlanner() = default;
+
+void MultiAgentPlanner::setGrid(const GridGraph * g, WorkerPool * workers){
+    grid = g;
+    pool = workers;
+    cols = g ? g->getCols() : 0;
+    rows = g ? g->getRows() : 0;
+    reservations.reset(cols);
+    distances.clear();
+    distanceGoals.clear();
+    searches.clear();
+    int threads = pool ? pool->getThreadCount() : 1;
+    for(int i = 0; i < threads; i++)
+        searches.emplace_back(new Search());
+}
+
+/**
+ * Hands the indices out through an atomic counter, one loop index per thread, so each thread
+ * keeps its own scratch buffers for every agent it takes.
+ */
+void MultiAgentPlanner::forEachAgent(int n, const std::function<void(int, Search&)>& f){
+    if(!pool || n <= 1){
+        for(int i = 0; i < n; i++)
+            f(i, *searches[0]);
+        return;
+    }
+    std::atomic<int> next{0};
+    int slots = std::min(int(searches.size()), n);
+    pool->parallelFor(slots, [&](int slot){
+        for(int i = next.fetch_add(1); i < n; i = next.fetch_add(1))
+            f(i, *searches[slot]);
+    });
+}
+
+int MultiAgentPlanner::heuristic(int agent, int tile) const {
+    const std::vector<int>& d = distances[agent];
+    if(!d.empty())
+        return d[tile];
+    int goal = goals[agent];
+    return std::abs(tile % cols - goal % cols) + std::abs(tile / cols - goal / cols);
+}
+
+/**
+ * One backward BFS per agent whose goal changed, in parallel. Too many (tiles x agents) for the
+ * memory: every agent falls back to the Manhattan distance.
+ */
+void MultiAgentPlanner::computeDistances(){
+    int n = int(goals.size());
+    distances.resize(n);
+    distanceGoals.resize(n, -1);
+    if(long(cols) * rows * n > MAX_HEURISTIC_CELLS){
+        for(int i = 0; i < n; i++){
+            distances[i].clear();
+            distances[i].shrink_to_fit();
+            distanceGoals[i] = -1;
+        }
+        return;
+    }
+    forEachAgent(n, [&](int i, Search& s){
+        if(distanceGoals[i] == goals[i] && !distances[i].empty())
+            return;
+        std::vector<int>& d = distances[i];
+        d.assign(std::size_t(cols) * rows, -1);
+        s.queue.clear();
+        d[goals[i]] = 0;
+        s.queue.push_back(goals[i]);
+        for(std::size_t head = 0; head < s.queue.size(); head++){
+            int u = s.queue[head];
+            int r = u / cols;
+            int c = u - r * cols;
+            int next[4] = {r > 0 ? u - cols : -1, r + 1 < rows ? u + cols : -1, c > 0 ? u - 1 : -1, c + 1 < cols ? u + 1 : -1};
+            for(int v : next){
+                if(v < 0 || d[v] >= 0 || grid->isBlocked(v))
+                    continue;
+                d[v] = d[u] + 1;
+                s.queue.push_back(v);
+            }
+        }
+        distanceGoals[i] = goals[i];
+    });
+}
+
+/**
+ * Space-time A* from the agent's start to its goal, avoiding the reservations of 'table'.
+ * The agent may only stop on its goal after the last time someone else holds it, so no path arrives
+ * before minArrival: f is max(t + h, minArrival), and the deepest-first tie-break then follows one
+ * path of waits instead of opening the whole space-time cone up to minArrival. Steps are
+ * bounded by the arrival allowed on the goal plus the free distance plus the perimeter of the grid
+ * (enough room to wait for the others), and the work by the expansion budget.
+ */
+bool MultiAgentPlanner::findPath(int agent, const ReservationTable& table, Search& s, std::vector<int>& path, SearchStats& stats) const {
+    int start = starts[agent];
+    int goal = goals[agent];
+    path.assign(1, start);
+    int h0 = heuristic(agent, start);
+    if(h0 < 0 || table.parkedSince(goal) != INT_MAX)
+        return false;
+    int minArrival = table.getLastHeld(goal) + 1;
+    int maxTime = minArrival + h0 + cols + rows;
+    long budget = maxExpansions > 0 ? maxExpansions : long(EXPANSIONS_PER_STEP) * maxTime;
+
+    s.nodes.clear();
+    s.open.clear();
+    s.seen.clear();
+    auto push = [&](int tile, int t, int parent, int h){
+        int& seen = s.seen.at((std::uint64_t(t) << 34) | std::uint64_t(tile), 0);
+        if(seen)
+            return;
+        seen = 1;
+        s.nodes.push_back({tile, t, parent});
+        s.open.push_back({std::max(t + h, minArrival), t, int(s.nodes.size()) - 1});
+        std::push_heap(s.open.begin(), s.open.end(), Search::later);
+        stats.pushed++;
+    };
+    push(start, 0, -1, h0);
+
+    long expanded = 0;
+    while(!s.open.empty()){
+        std::pop_heap(s.open.begin(), s.open.end(), Search::later);
+        int id = s.open.back().node;
+        s.open.pop_back();
+        Search::Node n = s.nodes[id];
+        stats.expanded++;
+        if(n.tile == goal && n.t >= minArrival){
+            path.resize(n.t + 1);
+            for(int k = id; k >= 0; k = s.nodes[k].parent)
+                path[s.nodes[k].t] = s.nodes[k].tile;
+            return true;
+        }
+        if(n.t >= maxTime)
+            continue;
+        if(++expanded > budget)
+            break;
+
+        int r = n.tile / cols;
+        int c = n.tile - r * cols;
+        int next[5] = {n.tile, r > 0 ? n.tile - cols : -1, r + 1 < rows ? n.tile + cols : -1,
+                       c > 0 ? n.tile - 1 : -1, c + 1 < cols ? n.tile + 1 : -1};
+        for(int v : next){
+            if(v < 0 || grid->isBlocked(v) || !table.canMove(n.tile, v, n.t))
+                continue;
+            int h = heuristic(agent, v);
+            if(h >= 0)
+                push(v, n.t + 1, id, h);
+        }
+    }
+    return false;
+}
+
+/**
+ * Rounds of PRIORITIZED_BATCH speculative searches against the reservations of the committed agents.
+ * An agent that finds no path is given up and stays on its start, parked there from step 0; the
+ * committed agents whose path crosses that tile are taken back and planned again around it.
+ */
+void MultiAgentPlanner::planPrioritized(){
+    int n = int(starts.size());
+    reservations.reset(cols);
+    std::vector<int> pending(n);
+    std::iota(pending.begin(), pending.end(), 0);
+    std::vector<int> h0(n);
+    for(int i = 0; i < n; i++)
+        h0[i] = heuristic(i, starts[i]);
+    std::stable_sort(pending.begin(), pending.end(), [&](int a, int b){return h0[a] > h0[b];});
+
+    std::vector<std::vector<int>> candidates(n);
+    std::vector<char> found(n, 0);
+    std::vector<char> failed(n, 0);
+    std::vector<SearchStats> work(n);
+    std::vector<int> committed; /// Agents whose path is reserved, in commit order
+    std::vector<int> roundAgents; /// The ones committed in the current round
+    ReservationTable round; /// Paths committed in the current round
+    round.reset(cols);
+    std::vector<int> retry;
+
+    /// Holds the start of every failed agent for good, then the paths of the given agents
+    auto rebuild = [&](ReservationTable& table, const std::vector<int>& agents){
+        table.clear();
+        for(int a = 0; a < n; a++)
+            if(failed[a])
+                table.park(starts[a], 0, a);
+        for(int a : agents)
+            table.reservePath(paths[a], a);
+    };
+    auto giveUp = [&](int a){
+        failed[a] = 1;
+        paths[a].assign(1, starts[a]);
+        auto crosses = [&](int c){
+            return std::find(paths[c].begin(), paths[c].end(), starts[a]) != paths[c].end();
+        };
+        if(std::none_of(committed.begin(), committed.end(), crosses)){
+            reservations.park(starts[a], 0, a);
+            round.park(starts[a], 0, a);
+            return;
+        }
+        for(int c : committed)
+            if(crosses(c))
+                retry.push_back(c);
+        committed.erase(std::remove_if(committed.begin(), committed.end(), crosses), committed.end());
+        roundAgents.erase(std::remove_if(roundAgents.begin(), roundAgents.end(), crosses), roundAgents.end());
+        rebuild(reservations, committed);
+        rebuild(round, roundAgents);
+    };
+
+    while(!pending.empty()){
+        int batch = std::min(int(pending.size()), PRIORITIZED_BATCH);
+        forEachAgent(batch, [&](int i, Search& s){
+            int a = pending[i];
+            work[a] = SearchStats();
+            found[a] = findPath(a, reservations, s, candidates[a], work[a]);
+        });
+        lastStats.searches += batch;
+        lastStats.rounds++;
+
+        round.clear();
+        roundAgents.clear();
+        retry.clear();
+        for(int i = 0; i < batch; i++){
+            int a = pending[i];
+            lastStats.lowLevel += work[a];
+            if(!found[a]){
+                giveUp(a);
+                continue;
+            }
+            //// For the first agent, only an agent given up earlier in the round can be in the way
+            if(!round.admits(candidates[a])){
+                retry.push_back(a);
+                continue;
+            }
+            paths[a] = candidates[a];
+            reservations.reservePath(paths[a], a);
+            round.reservePath(paths[a], a);
+            committed.push_back(a);
+            roundAgents.push_back(a);
+        }
+        retry.insert(retry.end(), pending.begin() + batch, pending.end());
+        pending.swap(retry);
+    }
+    for(int a : committed)
+        reached[a] = 1;
+}
+
+namespace {
+
+/**
+ * A CBS constraint: 'agent' may not be on tile 'to' at step t (from < 0),
+ * or may not move from -> to between t and t+1.
+ */
+struct Constraint {
+    int agent;
+    int from;
+    int to;
+    int t;
+};
+
+/**
+ * First conflict of a set of timed paths (an agent stays on its last tile).
+ * Vertex conflicts of a step are reported before the swaps leading to the next one.
+ */
+struct Conflict {
+    int a = -1;
+    int b = -1;
+    int tileA = -1; /// Vertex: the tile; swap: a moves tileA -> tileB and b tileB -> tileA
+    int tileB = -1;
+    int t = 0;
+    bool swap = false;
+};
+
+inline int positionAt(const std::vector<int>& p, int t){
+    return p[std::min<std::size_t>(t, p.size() - 1)];
+}
+
+/**
+ * Calls f for each conflict until it returns false.
+ */
+void forEachConflict(const std::vector<std::vector<int>>& paths, SpaceTimeHash& holders, const std::function<bool(const Conflict&)>& f){
+    int horizon = 0;
+    for(const auto& p : paths)
+        horizon = std::max(horizon, int(p.size()));
+    int n = int(paths.size());
+    holders.clear();
+    for(int t = 0; t < horizon; t++){
+        for(int i = 0; i < n; i++){
+            int tile = positionAt(paths[i], t);
+            int& h = holders.at((std::uint64_t(t) << 34) | std::uint64_t(tile), i);
+            if(h != i && !f(Conflict{h, i, tile, tile, t, false}))
+                return;
+        }
+        if(t == 0)
+            continue;
+        /// Swaps between t-1 and t: agent i went u -> v while the agent on v at t-1 went to u
+        for(int i = 0; i < n; i++){
+            int u = positionAt(paths[i], t - 1);
+            int v = positionAt(paths[i], t);
+            if(u == v)
+                continue;
+            int j = holders.find((std::uint64_t(t - 1) << 34) | std::uint64_t(v));
+            if(j > i && positionAt(paths[j], t) == u && !f(Conflict{i, j, u, v, t - 1, true}))
+                return;
+        }
+    }
+}
+
+}
+
+int MultiAgentPlanner::countConflicts(const std::vector<std::vector<int>>& timedPaths){
+    SpaceTimeHash holders;
+    int conflicts = 0;
+    forEachConflict(timedPaths, holders, [&](const Conflict&){conflicts++; return true;});
+    return conflicts;
+}
+
+/**
+ * Best-first search over the constraint tree, by sum of costs (ties: oldest node).
+ * Each node stores the paths of the whole team and its constraint; the constraints of a node are
+ * those on the way back to the root.
+ * @return False if the team is too large, an agent has no path, or CBS_MAX_NODES nodes were expanded
+ */
+bool MultiAgentPlanner::planConflictBased(){
+    int n = int(starts.size());
+    if(n > CBS_MAX_AGENTS)
+        return false;
+
+    struct Node {
+        int parent;
+        Constraint constraint;
+        std::vector<std::vector<int>> paths;
+        long cost;
+    };
+    auto costOf = [](const std::vector<std::vector<int>>& p){
+        long cost = 0;
+        for(const auto& path : p)
+            cost += long(path.size()) - 1;
+        return cost;
+    };
+
+    std::vector<Node> tree;
+    tree.push_back({-1, {-1, -1, -1, 0}, std::vector<std::vector<int>>(n), 0});
+    std::vector<SearchStats> work(std::max(n, 2));
+    std::vector<char> found(std::max(n, 2), 0);
+    ReservationTable none;
+    none.reset(cols);
+    forEachAgent(n, [&](int i, Search& s){found[i] = findPath(i, none, s, tree[0].paths[i], work[i]);});
+    lastStats.searches += n;
+    for(int i = 0; i < n; i++){
+        lastStats.lowLevel += work[i];
+        if(!found[i])
+            return false;
+    }
+    tree[0].cost = costOf(tree[0].paths);
+
+    typedef std::pair<long, int> Entry; /// (sum of costs, node)
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+    open.push({tree[0].cost, 0});
+    SpaceTimeHash holders;
+    ReservationTable tables[2];
+    std::vector<int> childPaths[2];
+    while(!open.empty() && lastStats.rounds < CBS_MAX_NODES){
+        int id = open.top().second;
+        open.pop();
+        lastStats.rounds++;
+
+        Conflict conflict;
+        forEachConflict(tree[id].paths, holders, [&](const Conflict& c){conflict = c; return false;});
+        if(conflict.a < 0){
+            paths = tree[id].paths;
+            std::fill(reached.begin(), reached.end(), 1);
+            return true;
+        }
+
+        Constraint added[2];
+        if(conflict.swap){
+            added[0] = {conflict.a, conflict.tileA, conflict.tileB, conflict.t};
+            added[1] = {conflict.b, conflict.tileB, conflict.tileA, conflict.t};
+        }
+        else{
+            added[0] = {conflict.a, -1, conflict.tileA, conflict.t};
+            added[1] = {conflict.b, -1, conflict.tileA, conflict.t};
+        }
+
+        /// Both children are replanned at once, each against its agent's constraints (held by "agent" n)
+        forEachAgent(2, [&](int k, Search& s){
+            int agent = added[k].agent;
+            ReservationTable& table = tables[k];
+            table.reset(cols);
+            auto apply = [&](const Constraint& c){
+                if(c.agent != agent)
+                    return;
+                if(c.from < 0)
+                    table.reserve(c.to, c.t, n);
+                else
+                    table.forbidMove(c.from, c.to, c.t, n);
+            };
+            apply(added[k]);
+            for(int node = id; node > 0; node = tree[node].parent)
+                apply(tree[node].constraint);
+            work[k] = SearchStats();
+            found[k] = findPath(agent, table, s, childPaths[k], work[k]);
+        });
+        lastStats.searches += 2;
+
+        for(int k = 0; k < 2; k++){
+            lastStats.lowLevel += work[k];
+            if(!found[k])
+                continue;
+            Node child{id, added[k], tree[id].paths, 0};
+            child.paths[added[k].agent] = childPaths[k];
+            child.cost = costOf(child.paths);
+            tree.push_back(std::move(child));
+            open.push({tree.back().cost, int(tree.size()) - 1});
+        }
+    }
+    return false;
+}
+
+const std::vector<std::vector<int>>& MultiAgentPlanner::plan(const std::vector<int>& startTiles, const std::vector<int>& goalTiles,
+                                                            MultiAgentMode mode){
+    auto begin = std::chrono::steady_clock::now();
+    lastStats = MultiAgentStats();
+    starts = startTiles;
+    goals = goalTiles;
+    int n = int(starts.size());
+    lastStats.agents = n;
+    paths.assign(n, std::vector<int>());
+    for(int i = 0; i < n; i++)
+        paths[i].assign(1, starts[i]);
+    reached.assign(n, 0);
+    computeDistances();
+
+    if(mode == MultiAgentMode::ConflictBased && !planConflictBased()){
+        lastStats.fellBack = true;
+        lastStats.rounds = 0;
+        planPrioritized();
+    }
+    else if(mode == MultiAgentMode::Prioritized)
+        planPrioritized();
+
+    for(int i = 0; i < n; i++){
+        if(!reached[i])
+            continue;
+        lastStats.solved++;
+        int steps = int(paths[i].size()) - 1;
+        lastStats.sumOfCosts += steps;
+        lastStats.makespan = std::max(lastStats.makespan, steps);
+    }
+    lastStats.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    return paths;
+}
@@ -0,0 +1,71 @@
+#include "PathCache.h"
+#include <utility>
+
+PathCache::PathCache(const PathCache& o){
+    *this = o;
+}
+
+PathCache& PathCache::operator=(const PathCache& o){
+    if(this != &o){
+        entries = o.entries;
+        copyState(o);
+    }
+    return *this;
+}
+
+PathCache& PathCache::operator=(PathCache&& o) noexcept {
+    if(this != &o){
+        entries = std::move(o.entries);
+        copyState(o);
+    }
+    return *this;
+}
+
+void PathCache::copyState(const PathCache& o){
+    capacity = o.capacity;
+    hits = o.hits;
+    misses = o.misses;
+    index.clear();
+    for(auto it = entries.begin(); it != entries.end(); ++it)
+        index[it->first] = it;
+}
+
+void PathCache::setCapacity(std::size_t maxPaths){
+    capacity = maxPaths;
+    while(entries.size() > capacity){
+        index.erase(entries.back().first);
+        entries.pop_back();
+    }
+}
+
+const std::vector<int> * PathCache::get(int start, int goal, unsigned long version){
+    if(!isEnabled())
+        return nullptr;
+    auto it = index.find(Key{start, goal, version});
+    if(it == index.end()){
+        misses++;
+        return nullptr;
+    }
+    /// Move to the front: most recently used
+    entries.splice(entries.begin(), entries, it->second);
+    hits++;
+    return &it->second->second;
+}
+
+void PathCache::put(int start, int goal, unsigned long version, const std::vector<int>& path){
+    if(!isEnabled())
+        return;
+    Key key{start, goal, version};
+    auto it = index.find(key);
+    if(it != index.end()){
+        it->second->second = path;
+        entries.splice(entries.begin(), entries, it->second);
+        return;
+    }
+    if(entries.size() == capacity){
+        index.erase(entries.back().first);
+        entries.pop_back();
+    }
+    entries.emplace_front(key, path);
+    index[key] = entries.begin();
+}
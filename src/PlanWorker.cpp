@@ -0,0 +1,68 @@
+#include "PlanWorker.h"
+#include <utility>
+
+PlanWorker::PlanWorker(Job j) : job(std::move(j)), thread(&PlanWorker::workerLoop, this) {}
+
+PlanWorker::~PlanWorker(){
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    thread.join();
+}
+
+/**
+ * The tiles changed for the replaced request are prepended: the incremental planners must
+ * still hear about them, since the worker never saw that request.
+ */
+long PlanWorker::request(PlanRequest&& r){
+    long generation;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        generation = latest.load() + 1;
+        r.generation = generation;
+        if(hasPending){
+            r.changedTiles.insert(r.changedTiles.begin(), pending.changedTiles.begin(), pending.changedTiles.end());
+            cancelled++;
+        }
+        pending = std::move(r);
+        hasPending = true;
+        latest.store(generation);
+    }
+    wake.notify_one();
+    return generation;
+}
+
+void PlanWorker::workerLoop(){
+    PlanRequest current;
+    while(true){
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this]{return hasPending || stopping;});
+            if(stopping)
+                return;
+            current = std::move(pending);
+            hasPending = false;
+        }
+        PlanResult& result = results.writeSlot();
+        result.generation = current.generation;
+        job(current, result);
+        //// A newer request was posted during the search: its result is the only one the robot wants
+        if(current.generation != latest.load()){
+            cancelled++;
+            continue;
+        }
+        results.publish();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            publishedGeneration = current.generation;
+        }
+        done.notify_all();
+    }
+}
+
+void PlanWorker::wait(long generation){
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [&]{return publishedGeneration >= generation;});
+}
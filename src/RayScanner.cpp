@@ -0,0 +1,199 @@
+#include "RayScanner.h"
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace {
+const float EPS = 1e-6f;
+}
+
+void RayScanner::configure(int rays, int maxRange){
+    rayCount = rays > 0 ? rays : 0;
+    range = maxRange > 0 ? maxRange : 0;
+    dirX.resize(rayCount);
+    dirY.resize(rayCount);
+    const double twoPi = 6.283185307179586;
+    for(int i = 0; i < rayCount; i++){
+        double a = twoPi * i / rayCount;
+        dirX[i] = float(std::cos(a));
+        dirY[i] = float(std::sin(a));
+    }
+}
+
+/**
+ * Ray along a row: the tiles (c+dx .. c+dx*range) are tested one 64-bit word at a time.
+ * @return Index of the first obstacle, or -1.
+ */
+int RayScanner::castHorizontal(const GridGraph& grid, int c, int r, int dx) const {
+    int cols = grid.getCols();
+    int first = c + dx;
+    int last = c + dx * range;
+    if(last < 0) last = 0;
+    if(last >= cols) last = cols - 1;
+    if(dx > 0 ? first > last : first < last)
+        return -1;
+
+    int lo = dx > 0 ? first : last;
+    int hi = dx > 0 ? last : first;
+    int wLo = lo >> 6;
+    int wHi = hi >> 6;
+    for(int i = 0; i <= wHi - wLo; i++){
+        int w = dx > 0 ? wLo + i : wHi - i;
+        std::uint64_t bits = grid.rowWord(r, w);
+        /// Keep only the columns in [lo, hi]
+        if(w == wLo) bits &= ~std::uint64_t(0) << (lo & 63);
+        if(w == wHi && (hi & 63) != 63) bits &= (std::uint64_t(1) << ((hi & 63) + 1)) - 1;
+        if(bits){
+            int bit = dx > 0 ? __builtin_ctzll(bits) : 63 - __builtin_clzll(bits);
+            return r * cols + (w << 6) + bit;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Ray along a column: one bit per row.
+ * @return Index of the first obstacle, or -1.
+ */
+int RayScanner::castVertical(const GridGraph& grid, int c, int r, int dy) const {
+    int cols = grid.getCols();
+    int rows = grid.getRows();
+    for(int i = 1, y = r + dy; i <= range && y >= 0 && y < rows; i++, y += dy){
+        int id = y * cols + c;
+        if(grid.isBlocked(id))
+            return id;
+    }
+    return -1;
+}
+
+/**
+ * Generic ray: visits the tiles crossed by the segment from the center of (c, r), in order,
+ * until an obstacle is found or the ray is longer than range.
+ * @return Index of the first obstacle, or -1.
+ */
+int RayScanner::castDDA(const GridGraph& grid, int c, int r, float dx, float dy) const {
+    int cols = grid.getCols();
+    int rows = grid.getRows();
+    int stepX = dx > 0 ? 1 : -1;
+    int stepY = dy > 0 ? 1 : -1;
+    const float INF = std::numeric_limits<float>::infinity();
+    /// Ray parameter t (in tiles) at which the next column/row boundary is crossed, and its increment
+    float tDeltaX = std::fabs(dx) > EPS ? 1.0f / std::fabs(dx) : INF;
+    float tDeltaY = std::fabs(dy) > EPS ? 1.0f / std::fabs(dy) : INF;
+    float tMaxX = 0.5f * tDeltaX;
+    float tMaxY = 0.5f * tDeltaY;
+
+    int x = c;
+    int y = r;
+    while(true){
+        float t;
+        if(tMaxX < tMaxY){
+            t = tMaxX;
+            tMaxX += tDeltaX;
+            x += stepX;
+        }
+        else{
+            t = tMaxY;
+            tMaxY += tDeltaY;
+            y += stepY;
+        }
+        if(t > range || x < 0 || x >= cols || y < 0 || y >= rows)
+            return -1;
+        int id = y * cols + x;
+        if(grid.isBlocked(id))
+            return id;
+    }
+}
+
+/**
+ * DDA ray of a traced or noisy scan: like castDDA, but each tile probed goes through the noise model
+ * and the tiles crossed are appended to 'crossed' (if not null).
+ * @return Index of the tile reported as a hit, or -1.
+ */
+int RayScanner::castTrace(const GridGraph& grid, int c, int r, float dx, float dy, std::vector<int>* crossed){
+    int cols = grid.getCols();
+    int rows = grid.getRows();
+    int stepX = dx > 0 ? 1 : -1;
+    int stepY = dy > 0 ? 1 : -1;
+    const float INF = std::numeric_limits<float>::infinity();
+    float tDeltaX = std::fabs(dx) > EPS ? 1.0f / std::fabs(dx) : INF;
+    float tDeltaY = std::fabs(dy) > EPS ? 1.0f / std::fabs(dy) : INF;
+    float tMaxX = 0.5f * tDeltaX;
+    float tMaxY = 0.5f * tDeltaY;
+    bool noisy = isNoisy();
+
+    int x = c;
+    int y = r;
+    while(true){
+        float t;
+        if(tMaxX < tMaxY){
+            t = tMaxX;
+            tMaxX += tDeltaX;
+            x += stepX;
+        }
+        else{
+            t = tMaxY;
+            tMaxY += tDeltaY;
+            y += stepY;
+        }
+        if(t > range || x < 0 || x >= cols || y < 0 || y >= rows)
+            return -1;
+        int id = y * cols + x;
+        bool blocked = grid.isBlocked(id);
+        if(noisy)
+            blocked = blocked ? uniform(rng) >= missedHitRate : uniform(rng) < falseHitRate;
+        if(blocked)
+            return id;
+        if(crossed)
+            crossed->push_back(id);
+    }
+}
+
+void RayScanner::setNoise(double falseHit, double missedHit, unsigned seed){
+    falseHitRate = falseHit > 0.0 ? falseHit : 0.0;
+    missedHitRate = missedHit > 0.0 ? missedHit : 0.0;
+    rng.seed(seed);
+}
+
+void RayScanner::traceRays(const GridGraph& grid, int origin, std::vector<int>& crossed, std::vector<int>& hits){
+    crossed.clear();
+    hits.clear();
+    if(!isEnabled())
+        return;
+    int c = origin % grid.getCols();
+    int r = origin / grid.getCols();
+    for(int i = 0; i < rayCount; i++){
+        int hit = castTrace(grid, c, r, dirX[i], dirY[i], &crossed);
+        if(hit >= 0)
+            hits.push_back(hit);
+    }
+}
+
+void RayScanner::scan(const GridGraph& grid, int origin, std::vector<int>& hits){
+    hits.clear();
+    if(!isEnabled())
+        return;
+    if(isNoisy()){
+        int c = origin % grid.getCols();
+        int r = origin / grid.getCols();
+        for(int i = 0; i < rayCount; i++){
+            int hit = castTrace(grid, c, r, dirX[i], dirY[i], nullptr);
+            if(hit >= 0)
+                hits.push_back(hit);
+        }
+        return;
+    }
+    int c = origin % grid.getCols();
+    int r = origin / grid.getCols();
+    for(int i = 0; i < rayCount; i++){
+        int hit;
+        if(std::fabs(dirY[i]) < EPS)
+            hit = castHorizontal(grid, c, r, dirX[i] > 0 ? 1 : -1);
+        else if(std::fabs(dirX[i]) < EPS)
+            hit = castVertical(grid, c, r, dirY[i] > 0 ? 1 : -1);
+        else
+            hit = castDDA(grid, c, r, dirX[i], dirY[i]);
+        if(hit >= 0)
+            hits.push_back(hit);
+    }
+}
@@ -0,0 +1,163 @@
+#include "ReplayView.h"
+#include <SFML/Graphics.hpp>
+#include <iostream>
+#include <sstream>
+#include "Map.h"
+#include "SfmlView.h"
+#include "TileRenderer.h"
+#include "SimClock.h"
+#include "Trace.h"
+
+namespace {
+
+/**
+ * Keeps the belief map of one robot and its highlighted path on the true map in sync with the replayed tick.
+ */
+class BeliefSync {
+    private:
+        const TraceReader& reader;
+        Map& trueMap;
+        Map& beliefMap;
+        int robot = 0; /// Robot whose belief map is shown
+        std::size_t applied = 0; /// Discoveries and clears already applied to beliefMap (prefix of reader.getDiscoveries())
+        std::vector<int> shownPath; /// Path currently highlighted on trueMap
+
+    public:
+        BeliefSync(const TraceReader& r, Map& truth, Map& belief) : reader(r), trueMap(truth), beliefMap(belief) {}
+
+        void update(){
+            const std::vector<TraceReader::Discovery>& all = reader.getDiscoveries();
+            std::size_t n = reader.countDiscoveriesUntil(reader.getTick());
+            if(n < applied){
+                /// Seeked backward: clear the map and replay the discoveries from the start
+                for(std::size_t i = 0; i < applied; i++)
+                    if(all[i].robot == robot)
+                        beliefMap.setTileType(all[i].tile, TileType::Empty);
+                applied = 0;
+            }
+            for(; applied < n; applied++)
+                if(all[applied].robot == robot)
+                    beliefMap.setTileType(all[applied].tile, all[applied].obstacle ? TileType::Obstacle : TileType::Empty);
+
+            const std::vector<int>& path = reader.getPath(robot);
+            if(path != shownPath){
+                trueMap.defaultColorTile(shownPath);
+                trueMap.setColorPath(path);
+                shownPath = path;
+            }
+        }
+
+        void setRobot(int r){
+            const std::vector<TraceReader::Discovery>& all = reader.getDiscoveries();
+            for(std::size_t i = 0; i < applied; i++)
+                if(all[i].robot == robot)
+                    beliefMap.setTileType(all[i].tile, TileType::Empty);
+            applied = 0;
+            robot = r;
+            update();
+        }
+
+        int getRobot() const {return robot;}
+};
+
+}
+
+int runReplay(const std::string& path){
+    TraceReader reader;
+    if(!reader.load(path))
+        return 1;
+    std::cout << "Replaying " << path << ": " << reader.getRobotCount() << " robot(s), "
+              << reader.getLastTick() << " ticks\n";
+
+    Map trueMap = Map::fromOccupancy(reader.getOccupancy(), reader.getTileSize());
+    trueMap.createTiles();
+    Map beliefMap = trueMap.cloneStructureWithoutObstacles();
+    TileRenderer trueMapView(&trueMap);
+    TileRenderer beliefMapView(&beliefMap);
+    BeliefSync belief(reader, trueMap, beliefMap);
+    belief.update();
+
+    /// Both windows show the whole map, whatever its size
+    sf::RenderWindow window1(sf::VideoMode(800, 600), "Replay");
+    sf::RenderWindow window2(sf::VideoMode(800, 600), "Robot Map");
+    sf::View whole(sf::FloatRect(0.f, 0.f, float(trueMap.getCols() * trueMap.getTileSize()),
+                                 float(trueMap.getRows() * trueMap.getTileSize())));
+    window1.setView(whole);
+    window2.setView(whole);
+    window1.setFramerateLimit(60);
+    window2.setFramerateLimit(60);
+
+    /// One replayed tick per simulation step: the trace plays at the speed it was recorded at (x1)
+    SimClock simClock;
+    sf::Clock frameClock;
+    sf::Clock titleClock;
+    bool paused = false;
+    const long seekStep = long(5.0 / simClock.getStepSeconds());
+
+    while(window1.isOpen() && window2.isOpen()){
+        sf::Event event;
+        for(sf::RenderWindow * window : {&window1, &window2}){
+            while(window->pollEvent(event)){
+                if(event.type == sf::Event::Closed)
+                    window->close();
+                if(event.type != sf::Event::KeyPressed)
+                    continue;
+                sf::Keyboard::Key key = event.key.code;
+                if(key == sf::Keyboard::Space)
+                    paused = !paused;
+                else if(key == sf::Keyboard::Add || key == sf::Keyboard::Equal)
+                    simClock.setMultiplier(simClock.getMultiplier() * 2.0);
+                else if(key == sf::Keyboard::Subtract || key == sf::Keyboard::Hyphen)
+                    simClock.setMultiplier(simClock.getMultiplier() / 2.0);
+                else if(key == sf::Keyboard::Left)
+                    reader.seek(reader.getTick() - seekStep);
+                else if(key == sf::Keyboard::Right)
+                    reader.seek(reader.getTick() + seekStep);
+                else if(key == sf::Keyboard::Comma)
+                    reader.seek(reader.getTick() - 1);
+                else if(key == sf::Keyboard::Period)
+                    reader.step();
+                else if(key == sf::Keyboard::Home)
+                    reader.seek(0);
+                else if(key == sf::Keyboard::End)
+                    reader.seek(reader.getLastTick());
+                else if(key >= sf::Keyboard::Num0 && key <= sf::Keyboard::Num9)
+                    reader.seek(reader.getLastTick() * (key - sf::Keyboard::Num0) / 10);
+                else if(key == sf::Keyboard::R)
+                    belief.setRobot((belief.getRobot() + 1) % reader.getRobotCount());
+            }
+        }
+
+        double frameSeconds = frameClock.restart().asSeconds();
+        if(!paused)
+            simClock.advance(frameSeconds, [&]{ reader.step(); });
+        belief.update();
+
+        window1.clear(sf::Color::Black);
+        window2.clear(sf::Color::Black);
+        trueMapView.update();
+        beliefMapView.update();
+        window1.draw(trueMapView);
+        window2.draw(beliefMapView);
+        for(int i = 0; i < reader.getRobotCount(); i++){
+            if(!reader.isPlaced(i))
+                continue;
+            sf::Color color = i == belief.getRobot() ? sf::Color::Red : sf::Color::Blue;
+            drawRobotAt(reader.getPosX(i), reader.getPosY(i), reader.getRadius(), window1, color);
+            if(i == belief.getRobot())
+                drawRobotAt(reader.getPosX(i), reader.getPosY(i), reader.getRadius(), window2, color);
+        }
+
+        if(titleClock.getElapsedTime().asSeconds() > 0.25f){
+            titleClock.restart();
+            std::ostringstream title;
+            title << "Replay - tick " << reader.getTick() << "/" << reader.getLastTick()
+                  << " - x" << simClock.getMultiplier() << (paused ? " - paused" : "");
+            window1.setTitle(title.str());
+        }
+
+        window1.display();
+        window2.display();
+    }
+    return 0;
+}
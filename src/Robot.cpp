@@ -1,14 +1,21 @@
 #include "Robot.h"
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <sstream>
+#include <string>
 
 /**
  * Robot constructor 
  * 
- * Initializes sensors, shape, position, and robot's internal map.
+ * Initializes sensors, position, and robot's internal map.
  */
-Robot::Robot(Map* m, int initX, int initY, int initR, sf::RenderWindow* w)
-    : map(m)
+Robot::Robot(Map* m, int initX, int initY, int initR, bool log, const Map* prior, RobotStates* store)
+    : map(m), verbose(log)
 {
+    states = store ? store : &ownStates;
+    slot = states->add(float(initX), float(initY), 0.5f);
+
     //// Initialize sensors for each direction
     sensors.emplace_back(Direction::Up, this, m);
     sensors.emplace_back(Direction::Down, this, m);
@@ -22,92 +29,193 @@ Robot::Robot(Map* m, int initX, int initY, int initR, sf::RenderWindow* w)
     y = initY;
     r = initR;
 
-    //// Create an internal map copy (no obstacles)
-    robotMap = map->cloneStructureWithoutObstacles();
-
-    shape = sf::CircleShape(r);
-    shape.setFillColor(sf::Color::Red);
-    shape.setPosition(sf::Vector2f(x, y));
+    //// Create the belief map (no obstacles, every tile unknown), sharing the prior's pages
+    robotMap = prior ? *prior : map->cloneBelief();
+    incrementalPlanner.setMap(&robotMap);
+    hierarchicalPlanner.setMap(&robotMap);
 
     int tileSize = map->getTileSize();
     int robot_col = x / tileSize; 
     int robot_row = y / tileSize; 
     currentTile = robot_row * map->getCols() + robot_col; 
-    std::cout << "CurrentRobotTile: " << currentTile << "\n";
+    if(verbose) std::cout << "CurrentRobotTile: " << currentTile << "\n";
+}
 
-    win = w;
+void Robot::setMetrics(MetricsRegistry * registry, int id){
+    if(!registry){
+        replanCounter = sensorHitCounter = nullptr;
+        expandedHistogram = pushedHistogram = latencyHistogram = pathLengthHistogram = ticksToGoalHistogram = nullptr;
+        return;
+    }
+    std::string label = "robot=" + std::to_string(id);
+    replanCounter = &registry->counter("robot.replans", label);
+    sensorHitCounter = &registry->counter("robot.sensor_hits", label);
+    expandedHistogram = &registry->histogram("search.expanded", plannerTypeToString(plannerType));
+    pushedHistogram = &registry->histogram("search.pushed", plannerTypeToString(plannerType));
+    latencyHistogram = &registry->histogram("search.latency_us", plannerTypeToString(plannerType));
+    pathLengthHistogram = &registry->histogram("path.length");
+    ticksToGoalHistogram = &registry->histogram("robot.ticks_to_goal");
 }
 
 void Robot::setX(int new_x){
-    sf::Vector2f pos = shape.getPosition();
-    shape.setPosition(new_x, pos.y);
+    stopCruise();
+    posX() = new_x;
 }
 
 void Robot::setY(int new_y){
-    sf::Vector2f pos = shape.getPosition();
-    shape.setPosition(pos.x, new_y);
+    stopCruise();
+    posY() = new_y;
+}
+
+/**
+ * A cruising robot only moves toward its target (RobotStates::advance, for this slot alone):
+ * the full update runs when it reaches the tile, when its sensor would see an obstacle there,
+ * and whenever it is not cruising.
+ */
+void Robot::update(){
+    if(states->flags[slot] & RobotStates::CRUISING){
+        float dx = states->targetX[slot] - posX();
+        float dy = states->targetY[slot] - posY();
+        if(dx * dx + dy * dy >= 1.0f && !map->getGrid().isBlocked(states->targetTile[slot])){
+            posX() += states->stepX[slot];
+            posY() += states->stepY[slot];
+            ticks()++;
+            return;
+        }
+    }
+    fullUpdate();
+    refreshCruise();
+}
+
+long Robot::run(long maxTicks){
+    long done = 0;
+    while(done < maxTicks && isRunning()){
+        long moves = std::min(states->cruiseTicks(slot, map->getGrid()), maxTicks - done);
+        if(moves > 0){
+            states->skip(slot, moves);
+            done += moves;
+            continue;
+        }
+        fullUpdate();
+        refreshCruise();
+        done++;
+    }
+    return done;
 }
 
 /**
  * Main logic loop for robot movement, sensing, and path following.
  */
-void Robot::update(sf::RenderWindow& window){
+void Robot::fullUpdate(){
     if(robotPlaced){
         if(canRunAlgo){
+            ticks()++;
             //// Reset sensor detection flags
-            detected = std::vector<bool>(4, false);
+            std::fill(detected.begin(), detected.end(), false);
+
+            //// Async planning: take the new path as soon as the worker publishes it
+            if(planPending){
+                adoptPath();
+                if(!canRunAlgo)
+                    return;
+            }
+
+            //// Without a path (log-odds belief): scan again every WAIT_SCAN_TICKS until an obstacle clears
+            if(waitingForPath){
+                if(ticks() % WAIT_SCAN_TICKS != 0)
+                    return;
+                scanSurroundings();
+                waitScans++;
+                if(!scanCleared){
+                    if(waitScans >= MAX_WAIT_SCANS){
+                        if(verbose) std::cout << "\nNo valid path to follow.\n";
+                        canRunAlgo = false;
+                    }
+                    return;
+                }
+                waitingForPath = false;
+                needToComputePath = true;
+            }
+
+            //// Range scan each time the robot enters a new tile
+            if(scanner.isEnabled() && !followingPlan && currentTile != lastScanTile){
+                lastScanTile = currentTile;
+                if(scanSurroundings())
+                    needToComputePath = true;
+            }
             
             //// True if it is the first time or when we find an obstacle
             if(needToComputePath){
-                std::cout<<"Recomputing path...\n";
-
-                map->defaultColorTile(pathToFollow); //// Reset color of previous path
-                robotMap.buildGraph(); //// Build graph based on updated internal map
-                pathToFollow.clear();
-                pathToFollow=robotMap.dijkstra(currentTile, endTile);
+                if(verbose) std::cout<<"Recomputing path...\n";
                 needToComputePath = false;
-                
-                //// For debugging: print of the path
-                for(auto p : pathToFollow)
-                    std::cout<<p<<"->"; 
-                
-                currentStep = 0;
-                map->setColorPath(pathToFollow); //// Visually mark new path
-                if(pathToFollow.size()==1){
-                    std::cout<<"\nNo valid path to follow.\n";
-                    canRunAlgo = false; 
-                    return; 
+
+                if(planWorker)
+                    requestPath();
+                else{
+                    if(highlightPath)
+                        map->defaultColorTile(pathToFollow); //// Reset color of previous path
+                    pathToFollow.clear();
+                    pathToFollow=computePath();
+
+                    //// For debugging: print of the path
+                    if(verbose)
+                        for(auto p : pathToFollow)
+                            std::cout<<p<<"->";
+
+                    currentStep() = 0;
+                    if(highlightPath)
+                        map->setColorPath(pathToFollow); //// Visually mark new path
+                    if(pathLengthHistogram && pathToFollow.size() > 1)
+                        pathLengthHistogram->record(double(pathToFollow.size() - 1));
+                    if(!pathFound(pathToFollow))
+                        return;
                 }
             }
 
-            if (currentStep >= pathToFollow.size()) {
-                window.draw(shape);
+            if (currentStep() >= pathToFollow.size()) {
+                if(planPending)
+                    return; //// Wait on the last safe tile for the worker's path
                 canRunAlgo = false; 
-                std::cout<<"\nEnd tile reached\n";
+                goalReached = true;
+                if(ticksToGoalHistogram)
+                    ticksToGoalHistogram->record(double(ticks()));
+                if(verbose) std::cout<<"\nEnd tile reached\n";
                 return;  
             }
 
-            int nextTile = pathToFollow[currentStep];
+            int nextTile = pathToFollow[currentStep()];
             int tileSize = map->getTileSize();
             int col = nextTile % map->getCols();
             int row = nextTile / map->getCols();
 
 
-            float radius = shape.getRadius();
-            sf::Vector2f targetPosition = {
-                col * tileSize + tileSize / 2.0f - radius,
-                row * tileSize + tileSize / 2.0f - radius
-            };
+            //// Wait step of a timed path: stay on the tile as long as a move takes
+            if(followingPlan && nextTile == currentTile){
+                if(++waitedTicks >= getStepTicks()){
+                    waitedTicks = 0;
+                    currentStep()++;
+                }
+                return;
+            }
 
-            sf::Vector2f currentPosition = shape.getPosition();
-            float dx = targetPosition.x - currentPosition.x;
-            float dy = targetPosition.y - currentPosition.y;
-            float distance = std::sqrt(dx * dx + dy * dy);
+            float radius = getRadius();
+            float targetX = col * tileSize + tileSize / 2.0f - radius;
+            float targetY = row * tileSize + tileSize / 2.0f - radius;
 
-            if (distance < 1.0f) {
-                //// Reached tile
+            float dx = targetX - posX();
+            float dy = targetY - posY();
+
+            //// Within 1 pixel of the center (squared distance: no square root)
+            if (dx * dx + dy * dy < 1.0f) {
+                //// Reached tile (a timed path snaps on it, so every step lasts the same number of ticks)
                 currentTile = nextTile;
-                currentStep++;
+                if(followingPlan){
+                    posX() = targetX;
+                    posY() = targetY;
+                }
+                if(currentTile != endTile)
+                    robotMap.setCellState(currentTile, CellState::Free);
+                currentStep()++;
             } else {
                 //// Simulate obstacle detection
                 for(int i=0; i<sensors.size(); i++){
@@ -120,33 +228,24 @@ void Robot::update(sf::RenderWindow& window){
                 ////take the nextDirection and check the corrispoding sensors
                 Direction d = getNewDirection(nextTile);
                 
-                //// Obstacle detection per direction
-                if(directionToString(d)=="Up" && detected[0]==true){
-                    nextMoveIsValide = false;
-                    robotMap.getTiles()[nextTile].setType(TileType::Obstacle);
-                    std::cout << "Obstacle detected above.\n";
-                    needToComputePath = true; 
-                }
-                if(directionToString(d)=="Down" && detected[1]==true){
-                    nextMoveIsValide = false;
-                    robotMap.getTiles()[nextTile].setType(TileType::Obstacle);
-                    std::cout << "Obstacle detected below.\n";
-                    needToComputePath = true; 
-                }
-                if(directionToString(d)=="Left" && detected[2]==true){
+                //// Obstacle detection: the sensors are in Direction order (Up, Down, Left, Right)
+                static const char* const sides[] = {"above", "below", "on the left", "on the right"};
+                if(d != Direction::None && detected[int(d)]){
                     nextMoveIsValide = false;
-                    robotMap.getTiles()[nextTile].setType(TileType::Obstacle);
-                    std::cout << "Obstacle detected on the left.\n";
-                    needToComputePath = true; 
+                    robotMap.setTileType(nextTile, TileType::Obstacle);
+                    if(verbose) std::cout << "Obstacle detected " << sides[int(d)] << ".\n";
+                    needToComputePath = true;
                 }
-                if(directionToString(d)=="Right" && detected[3]==true){
-                    nextMoveIsValide = false;
-                    robotMap.getTiles()[nextTile].setType(TileType::Obstacle);
-                    std::cout << "Obstacle detected on the right.\n";
-                    needToComputePath = true; 
-                }
-                if(needToComputePath)
+                if(needToComputePath){
+                    if(sensorHitCounter)
+                        sensorHitCounter->add();
+                    if(logDiscoveries)
+                        newDiscoveries.emplace_back(nextTile, true);
+                    if(beliefModel == BeliefModel::LogOdds)
+                        occupancy.setOccupied(nextTile);
+                    notifyPlanners(nextTile); //// Queue the repair around the new obstacle
                     return;
+                }
                 
                 //// No obstacle: proceed in the detected direction
                 if (d == Direction::Right) moveXpos();
@@ -156,22 +255,346 @@ void Robot::update(sf::RenderWindow& window){
             }
 
         }
-        window.draw(shape);
     }
 }
 
+/**
+ * The next tick is a plain move when the robot is running, has nothing to plan or scan,
+ * and heads to a neighbor tile of its path: its update would only poll the sensor facing
+ * that tile and move by speed toward its center.
+ */
+void Robot::refreshCruise(){
+    stopCruise();
+    if(!robotPlaced || !canRunAlgo || waitingForPath || planPending || needToComputePath)
+        return;
+    if(scanner.isEnabled() && !followingPlan && currentTile != lastScanTile)
+        return;
+    if(currentStep() >= int(pathToFollow.size()))
+        return;
+    int nextTile = pathToFollow[currentStep()];
+    int cols = map->getCols();
+    if(std::abs(nextTile / cols - currentTile / cols) + std::abs(nextTile % cols - currentTile % cols) != 1)
+        return;
+
+    int tileSize = map->getTileSize();
+    float radius = getRadius();
+    states->targetX[slot] = nextTile % cols * tileSize + tileSize / 2.0f - radius;
+    states->targetY[slot] = nextTile / cols * tileSize + tileSize / 2.0f - radius;
+    states->targetTile[slot] = nextTile;
+    Direction d = getNewDirection(nextTile);
+    states->stepX[slot] = d == Direction::Right ? speed() : d == Direction::Left ? -speed() : 0.f;
+    states->stepY[slot] = d == Direction::Down ? speed() : d == Direction::Up ? -speed() : 0.f;
+    states->flags[slot] |= RobotStates::CRUISING;
+}
+
+/**
+ * Casts the range scanner rays on the true map and copies the obstacles they hit into robotMap.
+ * With a log-odds belief the hits and the tiles crossed update the occupancy grid instead, and only
+ * the tiles whose thresholded state flips change robotMap (both ways).
+ * @return True if a newly discovered obstacle lies on the rest of the current path (or may lie on the
+ *         path being searched by the worker).
+ */
+bool Robot::scanSurroundings(){
+    bool pathBlocked = false;
+    auto discovered = [&](int tile){
+        if(sensorHitCounter)
+            sensorHitCounter->add();
+        if(logDiscoveries)
+            newDiscoveries.emplace_back(tile, true);
+        if(verbose) std::cout << "Obstacle detected by range scan on tile " << tile << "\n";
+        if(std::find(pathToFollow.begin() + std::min<size_t>(currentStep(), pathToFollow.size()), pathToFollow.end(), tile) != pathToFollow.end())
+            pathBlocked = true;
+        if(planPending)
+            pathBlocked = true; //// The running search may go through it: it is stale
+    };
+    scanCleared = false;
+
+    if(beliefModel == BeliefModel::LogOdds){
+        scanner.traceRays(map->getGrid(), currentTile, scanCrossed, scanHits);
+        for(int tile : scanCrossed){
+            occupancy.addMiss(tile);
+            if(robotMap.getCellState(tile) == CellState::Unknown)
+                robotMap.setCellState(tile, CellState::Free);
+        }
+        for(int hit : scanHits)
+            occupancy.addHit(hit);
+        occupancy.applyBatch(robotMap.getGrid(), flippedTiles);
+        for(int tile : flippedTiles){
+            bool blocked = !robotMap.getGrid().isBlocked(tile);
+            setBelief(tile, blocked);
+            if(blocked)
+                discovered(tile);
+            else{
+                clearedTiles++;
+                scanCleared = true;
+                if(logDiscoveries)
+                    newDiscoveries.emplace_back(tile, false);
+                if(verbose) std::cout << "Obstacle cleared by range scan on tile " << tile << "\n";
+            }
+        }
+        return pathBlocked;
+    }
+
+    scanner.scan(map->getGrid(), currentTile, scanHits);
+    for(int hit : scanHits){
+        if(robotMap.getGrid().isBlocked(hit))
+            continue;
+        setBelief(hit, true);
+        discovered(hit);
+    }
+    return pathBlocked;
+}
+
+void Robot::setBelief(int tile, bool blocked){
+    robotMap.setTileType(tile, blocked ? TileType::Obstacle : TileType::Empty);
+    notifyPlanners(tile);
+}
+
+void Robot::notifyPlanners(int tile){
+    if(planWorker){
+        changedTiles.push_back(tile);
+        return;
+    }
+    incrementalPlanner.notifyTileChanged(tile);
+    hierarchicalPlanner.notifyTileChanged(tile);
+}
+
+void Robot::setBeliefModel(BeliefModel m){
+    beliefModel = m;
+    if(m == BeliefModel::LogOdds)
+        occupancy.reset(robotMap.getCols(), robotMap.getRows(), robotMap.getGrid().isChunked());
+    else
+        occupancy.reset(0, 0, false);
+}
+
+/**
+ * Runs the selected planner on robotMap and logs the work it did.
+ */
+std::vector<int> Robot::computePath(){
+    SearchStats stats;
+    auto begin = std::chrono::steady_clock::now();
+    std::vector<int> path = runPlanner(robotMap, currentTile, endTile, stats, std::cout);
+    recordSearch(stats, std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count());
+    return path;
+}
+
+/**
+ * With D* Lite the first call is a full search and the following ones only repair the
+ * part of the search affected by the obstacles found since the previous call.
+ */
+std::vector<int> Robot::runPlanner(Map& on, int from, int to, SearchStats& stats, std::ostream& log){
+    std::vector<int> path;
+    if(plannerType == PlannerType::DStarLite){
+        bool fullSearch = !incrementalPlanner.hasGoal(to);
+        if(fullSearch)
+            incrementalPlanner.reset(from, to);
+        path = incrementalPlanner.plan(from);
+        stats = fullSearch ? incrementalPlanner.getFullSearchStats() : incrementalPlanner.getLastStats();
+        if(verbose && fullSearch)
+            log << "Full search expanded " << stats.expanded << " nodes, pushed " << stats.pushed << "\n";
+        else if(verbose)
+            log << "Repair expanded " << stats.expanded << " nodes, pushed " << stats.pushed
+                      << " (full search: " << incrementalPlanner.getFullSearchStats().expanded << " expanded)\n";
+    }
+    else if(plannerType == PlannerType::Hierarchical){
+        path = hierarchicalPlanner.findPath(from, to);
+        stats = hierarchicalPlanner.getLastStats();
+        if(verbose) log << "Hierarchical search expanded " << stats.expanded << " nodes, pushed " << stats.pushed
+                              << " (" << hierarchicalPlanner.getRebuiltClusters() << " clusters built so far)\n";
+    }
+    else if(plannerType == PlannerType::Landmarks){
+        //// The tables only know the obstacles discovered when they were built: rebuild them as the belief grows
+        bool build = !on.getLandmarks().isBuilt() || on.getVersion() - landmarkVersion >= LANDMARK_REBUILD;
+        if(build){
+            on.preprocessLandmarks(LANDMARKS);
+            landmarkVersion = on.getVersion();
+        }
+        path = on.aStarLandmarks(from, to);
+        stats = on.getLastSearchStats();
+        if(verbose) log << "ALT search expanded " << stats.expanded << " nodes, pushed " << stats.pushed
+                              << (build ? " (landmarks rebuilt)" : "") << "\n";
+    }
+    else if(plannerType == PlannerType::JumpPoint){
+        path = jumpPointPlanner.findPath(on.getGrid(), from, to);
+        stats = jumpPointPlanner.getLastStats();
+        if(verbose) log << "Full search expanded " << stats.expanded << " jump points, pushed " << stats.pushed << "\n";
+    }
+    else{
+        if(plannerType == PlannerType::AStar)
+            path = on.aStar(from, to);
+        else if(plannerType == PlannerType::Dial)
+            path = on.dial(from, to);
+        else
+            path = on.dijkstra(from, to);
+        stats = on.getLastSearchStats();
+        if(verbose) log << "Full search expanded " << stats.expanded << " nodes, pushed " << stats.pushed << "\n";
+    }
+    return path;
+}
+
+void Robot::recordSearch(const SearchStats& stats, double microseconds){
+    plannerTotals += stats;
+    replans++;
+    if(replanCounter){
+        replanCounter->add();
+        expandedHistogram->record(double(stats.expanded));
+        pushedHistogram->record(double(stats.pushed));
+        latencyHistogram->record(microseconds);
+    }
+}
+
+bool Robot::pathFound(const std::vector<int>& path){
+    if(path.size() != 1){
+        waitScans = 0;
+        return true;
+    }
+    if(beliefModel == BeliefModel::LogOdds && scanner.isEnabled() && waitScans < MAX_WAIT_SCANS){
+        //// The obstacles in the way may be false readings: later scans can clear them
+        if(verbose) std::cout<<"\nNo valid path, scanning again.\n";
+        waitingForPath = true;
+        return false;
+    }
+    if(verbose) std::cout<<"\nNo valid path to follow.\n";
+    canRunAlgo = false;
+    return false;
+}
+
+/**
+ * The worker plans on its own copy of the belief map (planMap: occupancy and costs, no tiles), bound to the
+ * incremental planners, so the robot keeps writing robotMap while a search runs. Each request brings the tiles
+ * changed since the previous one with their new state: the worker applies them to planMap, and the planners
+ * repair from them as in the synchronous case. Planner messages are kept in the result and printed by adoptPath.
+ */
+void Robot::setAsyncPlanning(bool b){
+    stopCruise();
+    if(b == (planWorker != nullptr))
+        return;
+    planPending = false;
+    changedTiles.clear();
+    if(!b){
+        planWorker.reset();
+        planMap = Map();
+        incrementalPlanner.setMap(&robotMap);
+        hierarchicalPlanner.setMap(&robotMap);
+        return;
+    }
+    planMap = Map::fromOccupancy(robotMap.getGrid(), robotMap.getTileSize());
+    planMap.setCosts(robotMap.getCosts());
+    incrementalPlanner.setMap(&planMap);
+    hierarchicalPlanner.setMap(&planMap);
+    planWorker.reset(new PlanWorker([this](PlanRequest& request, PlanResult& result){
+        for(const auto& change : request.changedTiles){
+            planMap.setCellState(change.first, change.second);
+            incrementalPlanner.notifyTileChanged(change.first);
+            hierarchicalPlanner.notifyTileChanged(change.first);
+        }
+        std::ostringstream log;
+        auto begin = std::chrono::steady_clock::now();
+        result.path = runPlanner(planMap, request.start, request.goal, result.stats, log);
+        result.microseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count();
+        result.log = log.str();
+    }));
+}
+
+/**
+ * The safe prefix is the rest of the path up to the first tile now believed blocked; it always ends on a
+ * tile the robot can stop on (the center of a tile it is on or moving to). The new search starts there.
+ * A request posted while the previous one is still running makes it stale.
+ */
+void Robot::requestPath(){
+    if(highlightPath)
+        map->defaultColorTile(pathToFollow);
+    std::size_t end = std::min<std::size_t>(currentStep(), pathToFollow.size());
+    while(end < pathToFollow.size() && !robotMap.getGrid().isBlocked(pathToFollow[end]))
+        end++;
+    pathToFollow.resize(end);
+    if(pathToFollow.empty()){
+        pathToFollow.push_back(currentTile);
+        currentStep() = 0;
+    }
+    if(highlightPath)
+        map->setColorPath(pathToFollow);
+
+    //// The prefix already reaches the goal: nothing to search, and an older answer must not be used
+    if(pathToFollow.back() == endTile){
+        planPending = false;
+        return;
+    }
+    PlanRequest request;
+    for(int tile : changedTiles)
+        request.changedTiles.emplace_back(tile, robotMap.getCellState(tile));
+    changedTiles.clear();
+    request.start = pathToFollow.back();
+    request.goal = endTile;
+    planGeneration = planWorker->request(std::move(request));
+    planPending = true;
+}
+
+void Robot::adoptPath(){
+    const PlanResult * result = planWorker->poll();
+    if(!result || result->generation != planGeneration)
+        return;
+    planPending = false;
+    recordSearch(result->stats, result->microseconds);
+    const std::vector<int>& path = result->path;
+    if(verbose){
+        std::cout << result->log;
+        for(auto p : path)
+            std::cout<<p<<"->";
+    }
+    if(pathLengthHistogram && path.size() > 1)
+        pathLengthHistogram->record(double(path.size() - 1));
+    if(!pathFound(path))
+        return;
+    //// path[0] is the last tile of the prefix
+    pathToFollow.insert(pathToFollow.end(), path.begin() + 1, path.end());
+    if(highlightPath)
+        map->setColorPath(pathToFollow);
+}
+
+/**
+ * Starts on timedPath[1]: timedPath[0] is the tile the robot is on.
+ * A path that does not end on the end tile (the team planner found none) stops the robot.
+ */
+void Robot::followPlan(const std::vector<int>& timedPath){
+    stopCruise();
+    if(highlightPath)
+        map->defaultColorTile(pathToFollow);
+    pathToFollow = timedPath;
+    currentStep() = 1;
+    waitedTicks = 0;
+    followingPlan = true;
+    needToComputePath = false;
+    waitingForPath = false;
+    if(pathToFollow.empty() || pathToFollow.back() != endTile){
+        if(verbose) std::cout << "\nNo valid path to follow.\n";
+        canRunAlgo = false;
+        return;
+    }
+    if(highlightPath)
+        map->setColorPath(pathToFollow);
+}
+
+/**
+ * A move covers speed pixels per tick and ends on the tick after the robot gets within 1 pixel of the tile center.
+ */
+int Robot::getStepTicks() const {
+    int tileSize = map->getTileSize();
+    return int(std::floor((tileSize - 1) / speed())) + 2;
+}
+
 //// Movement helpers
 void Robot::moveXpos(){
-    shape.move(speed, 0);
+    posX() += speed();
 }
 void Robot::moveXneg(){
-    shape.move(-speed, 0);
+    posX() -= speed();
 }
 void Robot::moveYpos(){
-    shape.move(0, speed);
+    posY() += speed();
 }
 void Robot::moveYneg(){
-    shape.move(0, -speed);
+    posY() -= speed();
 }
 
 /**
@@ -195,7 +618,8 @@ Direction Robot::getNewDirection(int tile){
  * Places robot at a specified tile position (column, row).
  */
 void Robot::placeRobot(int c, int r){
-    std::cout<<"Robot placed\n";
+    stopCruise();
+    if(verbose) std::cout<<"Robot placed\n";
     x = c*map->getTileSize()+map->getTileSize()/2;
     x-=25;
     y = r * map->getTileSize()+map->getTileSize()/2;
@@ -209,9 +633,12 @@ void Robot::placeRobot(int c, int r){
  * Updates internal path and highlights it visually on the map.
  */
 void Robot::setPath(const std::vector<int>& newPath){
+    stopCruise();
     pathToFollow = newPath;
+    if(!highlightPath)
+        return;
     for(int i=0; i<pathToFollow.size(); i++){
-        map->setBorderColorTile(sf::Color::Cyan, pathToFollow[i]);
+        map->setBorderColorTile(Color::Cyan, pathToFollow[i]);
     }
 }
 
@@ -0,0 +1,113 @@
+#include "RobotStates.h"
+#include <cmath>
+
+int RobotStates::add(float x, float y, float robotSpeed){
+    posX.push_back(x);
+    posY.push_back(y);
+    targetX.push_back(x);
+    targetY.push_back(y);
+    stepX.push_back(0.f);
+    stepY.push_back(0.f);
+    speed.push_back(robotSpeed);
+    targetTile.push_back(-1);
+    step.push_back(0);
+    ticks.push_back(0);
+    flags.push_back(0);
+    moving.push_back(0);
+    return size() - 1;
+}
+
+namespace {
+
+/**
+ * Arrival test: move[i] is 1 if slot i is cruising and still 1 pixel or more away from its target.
+ * Restrict arguments and 32-bit lanes: vectorized at -O3 (check with -fopt-info-vec).
+ */
+void arrivalKernel(const float* __restrict x, const float* __restrict y, const float* __restrict tx,
+                   const float* __restrict ty, const std::int32_t* __restrict flags, std::int32_t* __restrict move,
+                   std::size_t n){
+    for(std::size_t i = 0; i < n; i++){
+        float dx = tx[i] - x[i];
+        float dy = ty[i] - y[i];
+        std::int32_t away = dx * dx + dy * dy >= 1.0f;
+        move[i] = flags[i] & RobotStates::CRUISING & away;
+    }
+}
+
+/**
+ * Move kernel: the slots with move[i] set take one step and count one tick. Vectorized at -O3 like arrivalKernel.
+ */
+void moveKernel(float* __restrict x, float* __restrict y, const float* __restrict sx, const float* __restrict sy,
+                long* __restrict ticks, const std::int32_t* __restrict move, std::size_t n){
+    for(std::size_t i = 0; i < n; i++){
+        float m = float(move[i]);
+        x[i] += m * sx[i];
+        y[i] += m * sy[i];
+        ticks[i] += move[i];
+    }
+}
+
+}
+
+/**
+ * Robot::update reaches a tile when the distance to its center is below 1 pixel. Positions and
+ * targets are multiples of half a pixel, so the squared distance is exact and comparing it to 1
+ * gives the same answer as the square root.
+ *
+ * The two kernels run on SIMD lanes. In between, the sensor test reads the true map at each moving
+ * robot's target tile (a gather from the occupancy bits, scalar) and lists the other robots in pending.
+ */
+void RobotStates::advance(const GridGraph& trueMap, std::vector<int>& pending){
+    std::size_t n = posX.size();
+    pending.clear();
+    std::int32_t* move = moving.data();
+    arrivalKernel(posX.data(), posY.data(), targetX.data(), targetY.data(), flags.data(), move, n);
+
+    /// Sensor test: the target tile is the neighbor the robot is heading to
+    const int* target = targetTile.data();
+    for(std::size_t i = 0; i < n; i++){
+        if(move[i] && trueMap.isBlocked(target[i]))
+            move[i] = 0;
+        if(!move[i])
+            pending.push_back(int(i));
+    }
+
+    moveKernel(posX.data(), posY.data(), stepX.data(), stepY.data(), ticks.data(), move, n);
+}
+
+/**
+ * The robot moves along one axis: 'along' is what is left to the target on that axis, 'across' the offset
+ * on the other one. After j moves it is at along - j * step, and it stops moving at the first j where
+ * (along - j * step)^2 + across^2 < 1. The closed form gives j; it is then checked with the float
+ * expression advance() evaluates. Positions, targets and steps are multiples of half a pixel, so j moves
+ * at once land exactly where j single moves do.
+ */
+long RobotStates::cruiseTicks(int i, const GridGraph& trueMap) const {
+    if(!(flags[i] & CRUISING) || trueMap.isBlocked(targetTile[i]))
+        return 0;
+    bool alongX = stepX[i] != 0.f;
+    float step = alongX ? stepX[i] : stepY[i];
+    float along = alongX ? targetX[i] - posX[i] : targetY[i] - posY[i];
+    float across = alongX ? targetY[i] - posY[i] : targetX[i] - posX[i];
+    if(step == 0.f || across * across >= 1.0f)
+        return NEVER;
+    auto moves = [&](long j){
+        float d = along - float(j) * step;
+        return d * d + across * across >= 1.0f;
+    };
+
+    /// Steps to the target and half-width of the arrival window, in steps
+    double u = double(along) / step;
+    double w = std::sqrt(1.0 - double(across) * across) / std::fabs(step);
+    if(u + w <= 0.0)
+        return NEVER; /// Moving away from the target
+    long j = u - w < 0.0 ? 0 : long(std::floor(u - w)) + 1;
+    while(j > 0 && !moves(j - 1))
+        j--;
+    while(moves(j)){
+        if(j > u + w + 1.0)
+            return NEVER; /// Steps over the window
+        j++;
+    }
+    return j;
+}
@@ -0,0 +1,193 @@
+#include "ScenarioGenerator.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+GridGraph ScenarioGenerator::randomGrid(int cols, int rows, double density, unsigned seed){
+    GridGraph g(cols, rows);
+    std::mt19937 rng(seed);
+    std::bernoulli_distribution isObstacle(density);
+    for(int i = 0; i < cols * rows; i++)
+        if(isObstacle(rng))
+            g.setBlocked(i, true);
+    return g;
+}
+
+GridGraph ScenarioGenerator::mazeGrid(int cols, int rows, unsigned seed){
+    GridGraph g(cols, rows);
+    for(int i = 0; i < cols * rows; i++)
+        g.setBlocked(i, true);
+    int cellsX = (cols + 1) / 2;
+    int cellsY = (rows + 1) / 2;
+    std::vector<char> visited(std::size_t(cellsX) * cellsY, 0);
+    std::vector<int> stack{0};
+    visited[0] = 1;
+    g.setBlocked(0, false);
+    std::mt19937 rng(seed);
+    const int dx[4] = {1, -1, 0, 0};
+    const int dy[4] = {0, 0, 1, -1};
+    while(!stack.empty()){
+        int cell = stack.back();
+        int cx = cell % cellsX;
+        int cy = cell / cellsX;
+        int options[4];
+        int n = 0;
+        for(int k = 0; k < 4; k++){
+            int nx = cx + dx[k];
+            int ny = cy + dy[k];
+            if(nx >= 0 && nx < cellsX && ny >= 0 && ny < cellsY && !visited[ny * cellsX + nx])
+                options[n++] = k;
+        }
+        if(n == 0){
+            stack.pop_back();
+            continue;
+        }
+        int k = options[rng() % n];
+        int nx = cx + dx[k];
+        int ny = cy + dy[k];
+        visited[ny * cellsX + nx] = 1;
+        g.setBlocked((2 * cy + dy[k]) * cols + 2 * cx + dx[k], false); /// Wall between the two cells
+        g.setBlocked(2 * ny * cols + 2 * nx, false);
+        stack.push_back(ny * cellsX + nx);
+    }
+    return g;
+}
+
+GridGraph ScenarioGenerator::roomsGrid(int cols, int rows, double density, unsigned seed, int minRoom){
+    GridGraph g(cols, rows);
+    std::mt19937 rng(seed);
+    /// Doors and the tiles on both sides of them stay free
+    std::vector<char> keepFree(std::size_t(cols) * rows, 0);
+
+    struct Region {int x0, y0, x1, y1;}; /// [x0, x1) x [y0, y1)
+    std::vector<Region> stack{{0, 0, cols, rows}};
+    while(!stack.empty()){
+        Region r = stack.back();
+        stack.pop_back();
+        int w = r.x1 - r.x0;
+        int h = r.y1 - r.y0;
+        bool vertical = w > h || (w == h && rng() % 2 == 0);
+        int span = vertical ? w : h;
+        if(span < 2 * minRoom + 1){
+            vertical = !vertical;
+            span = vertical ? w : h;
+            if(span < 2 * minRoom + 1)
+                continue;
+        }
+        int lo = vertical ? r.x0 : r.y0;
+        int wall = lo + minRoom + int(rng() % unsigned(span - 2 * minRoom));
+        int length = vertical ? h : w;
+        int door = int(rng() % unsigned(length));
+        for(int k = 0; k < length; k++){
+            int x = vertical ? wall : r.x0 + k;
+            int y = vertical ? r.y0 + k : wall;
+            int id = y * cols + x;
+            if(k == door){
+                keepFree[id] = 1;
+                if(vertical){
+                    keepFree[id - 1] = 1;
+                    keepFree[id + 1] = 1;
+                }
+                else{
+                    keepFree[id - cols] = 1;
+                    keepFree[id + cols] = 1;
+                }
+            }
+            else if(!keepFree[id])
+                g.setBlocked(id, true);
+        }
+        if(vertical){
+            stack.push_back({r.x0, r.y0, wall, r.y1});
+            stack.push_back({wall + 1, r.y0, r.x1, r.y1});
+        }
+        else{
+            stack.push_back({r.x0, r.y0, r.x1, wall});
+            stack.push_back({r.x0, wall + 1, r.x1, r.y1});
+        }
+    }
+
+    std::bernoulli_distribution isObstacle(density);
+    for(int i = 0; i < cols * rows; i++)
+        if(!keepFree[i] && !g.isBlocked(i) && isObstacle(rng))
+            g.setBlocked(i, true);
+    return g;
+}
+
+CostLayer ScenarioGenerator::terrainCosts(int cols, int rows, unsigned seed){
+    CostLayer costs;
+    costs.assign(cols, rows, 2);
+    std::mt19937 rng(seed);
+    /// About one slow zone per 256 tiles, each up to a quarter of the map wide
+    int zones = std::max(1, cols * rows / 256);
+    for(int z = 0; z < zones; z++){
+        int w = 1 + int(rng() % unsigned(std::max(1, cols / 4)));
+        int h = 1 + int(rng() % unsigned(std::max(1, rows / 4)));
+        int x0 = int(rng() % unsigned(cols));
+        int y0 = int(rng() % unsigned(rows));
+        std::uint8_t cost = std::uint8_t(6 + rng() % 4);
+        for(int y = y0; y < std::min(rows, y0 + h); y++)
+            for(int x = x0; x < std::min(cols, x0 + w); x++)
+                costs.set(cols, rows, y * cols + x, cost);
+    }
+    /// One lane every 16 rows and every 16 columns, at a random offset
+    for(int y = int(rng() % 16u); y < rows; y += 16)
+        for(int x = 0; x < cols; x++)
+            costs.set(cols, rows, y * cols + x, 1);
+    for(int x = int(rng() % 16u); x < cols; x += 16)
+        for(int y = 0; y < rows; y++)
+            costs.set(cols, rows, y * cols + x, 1);
+    return costs;
+}
+
+bool ScenarioGenerator::generate(const ScenarioSpec& spec, GridGraph& grid, int& start, int& goal){
+    switch(spec.kind){
+        case MapKind::Random: grid = randomGrid(spec.cols, spec.rows, spec.density, spec.seed); break;
+        case MapKind::Maze: grid = mazeGrid(spec.cols, spec.rows, spec.seed); break;
+        case MapKind::Rooms: grid = roomsGrid(spec.cols, spec.rows, spec.density, spec.seed); break;
+        default: grid = GridGraph(spec.cols, spec.rows); break;
+    }
+
+    /// Start and goal come from their own stream, so they do not shift when a generator changes
+    std::mt19937 rng(spec.seed ^ 0x9e3779b9u);
+    std::uniform_int_distribution<int> anyTile(0, grid.size() - 1);
+    int minDistance = (spec.cols + spec.rows) / 4;
+    std::vector<int> distance(grid.size());
+    std::vector<int> queue;
+    for(int attempt = 0; attempt < 16; attempt++){
+        int s = anyTile(rng);
+        for(int tries = 0; grid.isBlocked(s) && tries < 64; tries++)
+            s = anyTile(rng);
+        if(grid.isBlocked(s))
+            continue;
+
+        /// Breadth-first search from the start: the goal must be reachable
+        std::fill(distance.begin(), distance.end(), -1);
+        queue.assign(1, s);
+        distance[s] = 0;
+        for(std::size_t head = 0; head < queue.size(); head++){
+            int u = queue[head];
+            grid.forEachNeighbor(u, [&](int v, float){
+                if(distance[v] < 0){
+                    distance[v] = distance[u] + 1;
+                    queue.push_back(v);
+                }
+            });
+        }
+        std::vector<int> far;
+        for(int t : queue)
+            if(distance[t] >= minDistance)
+                far.push_back(t);
+        const std::vector<int>& candidates = far.empty() ? queue : far;
+        if(candidates.size() < 2 && queue.size() < 2)
+            continue;
+        int g = candidates[rng() % candidates.size()];
+        if(g == s)
+            g = queue.back();
+        if(g == s)
+            continue;
+        start = s;
+        goal = g;
+        return true;
+    }
+    return false;
+}
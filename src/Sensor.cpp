@@ -4,7 +4,7 @@
 #include "Map.h"
 
 
-Sensor::Sensor(Direction Direction, Robot * r, Map * m){
+Sensor::Sensor(Direction Direction, Robot * r, const Map * m){
     detectionChecked = false; 
     robot = r; 
     d = Direction;
@@ -13,7 +13,8 @@ Sensor::Sensor(Direction Direction, Robot * r, Map * m){
 
 /**
  * Checks the tile in the specificied direction from the robot's current tile.
- * If the tile contains an obstacle, sets detectionChecked to true
+ * If the tile contains an obstacle, sets detectionChecked to true.
+ * The occupancy bit is read in place: nothing is copied from the map.
  */
 void Sensor::active(){
 
@@ -36,8 +37,7 @@ void Sensor::active(){
     
     /// If a valid tile was found, check its type
     if (tileToBeChecked >= 0) {
-        std::vector<Tile> tiles = map->getTiles();
-        detectionChecked = (tiles[tileToBeChecked].getType() == TileType::Obstacle);
+        detectionChecked = map->getGrid().isBlocked(tileToBeChecked);
     } else {
         detectionChecked = false;
     }
@@ -0,0 +1,19 @@
+#include "SfmlView.h"
+
+/**
+ * Draws the robot shape from the robot's pose.
+ * @param robot The robot to draw
+ * @param window The SFML window to render to
+ */
+void drawRobot(const Robot& robot, sf::RenderWindow& window){
+    if(!robot.isPlaced())
+        return;
+    drawRobotAt(robot.getPosX(), robot.getPosY(), robot.getRadius(), window);
+}
+
+void drawRobotAt(float x, float y, float radius, sf::RenderWindow& window, sf::Color color){
+    sf::CircleShape shape(radius);
+    shape.setFillColor(color);
+    shape.setPosition(x, y);
+    window.draw(shape);
+}
@@ -1,14 +1,9 @@
 #include "Tile.h"
 
 /**
- * Construts the tile shape and inizializes its color and outline
+ * Construts the tile and inizializes its color and outline
  */
-Tile::Tile(float x, float y, int s, TileType t) : type(t) {
-    shape.setPosition(x, y);
-    shape.setFillColor(sf::Color::White);
-    shape.setOutlineColor(sf::Color::Black);   
-    shape.setSize(sf::Vector2f(s,s));
-    shape.setOutlineThickness(1.f);             
+Tile::Tile(float x, float y, int s, TileType t) : x(x), y(y), type(t), Size(s) {
 }
 
 /**
@@ -17,10 +12,10 @@ Tile::Tile(float x, float y, int s, TileType t) : type(t) {
 void Tile::setType(TileType newType) {
     type = newType;
     switch (type) {
-        case TileType::Empty:    shape.setFillColor(sf::Color::White); break;
-        case TileType::Obstacle: shape.setFillColor(sf::Color::Black); break;
-        case TileType::Start:    shape.setFillColor(sf::Color::Green); break;
-        case TileType::Goal:     shape.setFillColor(sf::Color::Blue); break;
+        case TileType::Empty:    fillColor = Color::White; break;
+        case TileType::Obstacle: fillColor = Color::Black; break;
+        case TileType::Start:    fillColor = Color::Green; break;
+        case TileType::Goal:     fillColor = Color::Blue; break;
     }
 }
 
@@ -30,17 +25,3 @@ void Tile::setType(TileType newType) {
 TileType Tile::getType() const {
     return type;
 }
-
-/**
- * Draws the tile to the given SFML render window.
- */
-void Tile::draw(sf::RenderWindow& window) const {
-    window.draw(shape);
-}
-
-/**
- * Returns the internal RectangleShape (copy).
- */
-sf::RectangleShape Tile::getShape(){
-    return shape;
-}
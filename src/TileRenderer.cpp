@@ -0,0 +1,68 @@
+#include "TileRenderer.h"
+#include "SfmlView.h"
+
+namespace {
+/// Appends the two triangles of the rectangle [x0,x1) x [y0,y1)
+void appendRect(sf::VertexArray& va, std::size_t& at, float x0, float y0, float x1, float y1){
+    va[at++].position = sf::Vector2f(x0, y0);
+    va[at++].position = sf::Vector2f(x1, y0);
+    va[at++].position = sf::Vector2f(x1, y1);
+    va[at++].position = sf::Vector2f(x0, y0);
+    va[at++].position = sf::Vector2f(x1, y1);
+    va[at++].position = sf::Vector2f(x0, y1);
+}
+}
+
+TileRenderer::TileRenderer(Map * m) : map(m), vertices(sf::Triangles) {
+    rebuild();
+}
+
+/**
+ * Lays out the geometry of every tile: the fill first, then the outline ring around it,
+ * in tile order (the same drawing order as one RectangleShape per tile).
+ */
+void TileRenderer::rebuild(){
+    const std::vector<Tile>& tiles = map->getTiles();
+    tileCount = tiles.size();
+    vertices.resize(tileCount * VERTICES_PER_TILE);
+
+    std::size_t at = 0;
+    for(const Tile& tile : tiles){
+        TileBounds b = tile.getGlobalBounds();
+        float x0 = b.left, y0 = b.top;
+        float x1 = b.left + b.width, y1 = b.top + b.height;
+        appendRect(vertices, at, x0, y0, x1, y1);                 /// Fill
+        appendRect(vertices, at, x0 - 1, y0 - 1, x1 + 1, y0);     /// Outline: top
+        appendRect(vertices, at, x0 - 1, y1, x1 + 1, y1 + 1);     /// Outline: bottom
+        appendRect(vertices, at, x0 - 1, y0, x0, y1);             /// Outline: left
+        appendRect(vertices, at, x1, y0, x1 + 1, y1);             /// Outline: right
+    }
+    for(std::size_t id = 0; id < tileCount; id++)
+        writeColors(int(id));
+    map->clearDirtyTiles();
+}
+
+void TileRenderer::writeColors(int id){
+    const Tile& tile = map->getTiles()[id];
+    sf::Color fill = toSfColor(tile.getFillColor());
+    sf::Color border = toSfColor(tile.getBorderColor());
+    std::size_t base = std::size_t(id) * VERTICES_PER_TILE;
+    for(int i = 0; i < 6; i++)
+        vertices[base + i].color = fill;
+    for(int i = 6; i < VERTICES_PER_TILE; i++)
+        vertices[base + i].color = border;
+}
+
+void TileRenderer::update(){
+    if(map->getTiles().size() != tileCount){
+        rebuild();
+        return;
+    }
+    for(int id : map->getDirtyTiles())
+        writeColors(id);
+    map->clearDirtyTiles();
+}
+
+void TileRenderer::draw(sf::RenderTarget& target, sf::RenderStates states) const {
+    target.draw(vertices, states);
+}
@@ -0,0 +1,428 @@
+#include "Trace.h"
+#include "Map.h"
+#include "Robot.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <memory>
+
+namespace {
+
+const char MAGIC[4] = {'R', 'S', 'T', 'R'};
+const std::size_t BLOCK = 1 << 16; /// Bytes accumulated before a write to the file
+
+void putVarint(std::vector<std::uint8_t>& out, std::uint64_t v){
+    while(v >= 0x80){
+        out.push_back(std::uint8_t(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(std::uint8_t(v));
+}
+
+/// Zigzag: small negative numbers get small codes too (0, -1, 1, -2... -> 0, 1, 2, 3...)
+void putSigned(std::vector<std::uint8_t>& out, std::int64_t v){
+    putVarint(out, (std::uint64_t(v) << 1) ^ std::uint64_t(v >> 63));
+}
+
+void putRecord(std::vector<std::uint8_t>& out, TraceRecord r){
+    out.push_back(std::uint8_t(r));
+}
+
+/// Reads a varint; past the end of the data it sets pos beyond data.size() and returns 0
+std::uint64_t getVarint(const std::vector<std::uint8_t>& data, std::size_t& pos){
+    std::uint64_t v = 0;
+    for(int shift = 0; shift < 64; shift += 7){
+        if(pos >= data.size()){
+            pos = data.size() + 1;
+            return 0;
+        }
+        std::uint8_t b = data[pos++];
+        v |= std::uint64_t(b & 0x7f) << shift;
+        if(!(b & 0x80))
+            return v;
+    }
+    return v;
+}
+
+std::int64_t getSigned(const std::vector<std::uint8_t>& data, std::size_t& pos){
+    std::uint64_t v = getVarint(data, pos);
+    return std::int64_t(v >> 1) ^ -std::int64_t(v & 1);
+}
+
+std::int32_t toFixed(float v){
+    return std::int32_t(std::lround(v * TraceRecorder::FIXED_POINT));
+}
+
+}
+
+/// ------------------------ TraceRecorder ------------------------
+
+bool TraceRecorder::open(const std::string& path, const Map& trueMap, int robotCount, float radius, std::uint32_t interval){
+    close();
+    out.open(path, std::ios::binary | std::ios::trunc);
+    if(!out){
+        std::cerr << "Cannot write trace file " << path << "\n";
+        return false;
+    }
+    const GridGraph& grid = trueMap.getGrid();
+    TraceHeader h{};
+    std::memcpy(h.magic, MAGIC, 4);
+    h.version = VERSION;
+    h.cols = std::uint32_t(grid.getCols());
+    h.rows = std::uint32_t(grid.getRows());
+    h.tileSize = std::uint32_t(trueMap.getTileSize());
+    h.robotCount = std::uint32_t(robotCount);
+    h.keyInterval = interval > 0 ? interval : 1;
+    h.radius = radius;
+
+    buffer.clear();
+    const std::uint8_t * bytes = reinterpret_cast<const std::uint8_t*>(&h);
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(h));
+    std::vector<std::uint64_t> words(std::size_t(grid.getWordsPerRow()) * grid.getRows());
+    grid.copyWords(words.data());
+    bytes = reinterpret_cast<const std::uint8_t*>(words.data());
+    buffer.insert(buffer.end(), bytes, bytes + words.size() * 8);
+
+    robots.assign(std::size_t(robotCount), RobotState());
+    keyInterval = h.keyInterval;
+    tick = 0;
+    lastWrittenTick = 0;
+    bytesWritten = 0;
+    flush();
+    return bool(out);
+}
+
+void TraceRecorder::flush(){
+    out.write(reinterpret_cast<const char*>(buffer.data()), std::streamsize(buffer.size()));
+    bytesWritten += long(buffer.size());
+    buffer.clear();
+}
+
+void TraceRecorder::captureRobot(int id, Robot& robot){
+    RobotState& s = robots[id];
+    std::int32_t x = toFixed(robot.getPosX());
+    std::int32_t y = toFixed(robot.getPosY());
+    if(tick > 0){
+        std::int32_t vx = x - s.x;
+        std::int32_t vy = y - s.y;
+        if(vx != s.vx || vy != s.vy){
+            putRecord(events, TraceRecord::Velocity);
+            putVarint(events, std::uint64_t(id));
+            putSigned(events, vx);
+            putSigned(events, vy);
+            s.vx = vx;
+            s.vy = vy;
+        }
+    }
+    s.x = x;
+    s.y = y;
+    if(robot.isPlaced() != s.placed){
+        /// Placement is only stored in keyframes: force one on this tick
+        s.placed = robot.isPlaced();
+        placementChanged = true;
+    }
+
+    for(const std::pair<int, bool>& d : robot.getNewDiscoveries()){
+        putRecord(events, d.second ? TraceRecord::Discovery : TraceRecord::Clear);
+        putVarint(events, std::uint64_t(id));
+        putVarint(events, std::uint64_t(d.first));
+    }
+    robot.clearNewDiscoveries();
+
+    if(robot.getReplans() != s.replans){
+        s.replans = robot.getReplans();
+        const std::vector<int>& path = robot.getPath();
+        putRecord(events, TraceRecord::Path);
+        putVarint(events, std::uint64_t(id));
+        putVarint(events, path.size());
+        for(std::size_t i = 0; i < path.size(); i++){
+            if(i == 0)
+                putVarint(events, std::uint64_t(path[0]));
+            else
+                putSigned(events, path[i] - path[i - 1]); /// +-1 or +-cols on a 4-connected path
+        }
+    }
+
+    if(robot.hasReachedGoal() && !s.goal){
+        s.goal = true;
+        putRecord(events, TraceRecord::Goal);
+        putVarint(events, std::uint64_t(id));
+    }
+}
+
+void TraceRecorder::endTick(){
+    bool key = tick % keyInterval == 0 || placementChanged;
+    placementChanged = false;
+    if(events.empty() && !key)
+        return;
+    if(tick != lastWrittenTick){
+        putRecord(buffer, TraceRecord::Tick);
+        putVarint(buffer, std::uint64_t(tick - lastWrittenTick));
+        lastWrittenTick = tick;
+    }
+    buffer.insert(buffer.end(), events.begin(), events.end());
+    events.clear();
+    if(key){
+        putRecord(buffer, TraceRecord::Key);
+        putVarint(buffer, std::uint64_t(tick));
+        for(const RobotState& s : robots){
+            putSigned(buffer, s.x);
+            putSigned(buffer, s.y);
+            putSigned(buffer, s.vx);
+            putSigned(buffer, s.vy);
+            buffer.push_back(std::uint8_t((s.placed ? 1 : 0) | (s.goal ? 2 : 0)));
+        }
+    }
+    if(buffer.size() >= BLOCK)
+        flush();
+}
+
+void TraceRecorder::close(){
+    if(!out.is_open())
+        return;
+    putRecord(buffer, TraceRecord::End);
+    putVarint(buffer, std::uint64_t(tick));
+    flush();
+    out.close();
+}
+
+/// ------------------------ TraceReader ------------------------
+
+bool TraceReader::load(const std::string& path){
+    std::ifstream in(path, std::ios::binary);
+    if(!in){
+        std::cerr << "Cannot open trace file " << path << "\n";
+        return false;
+    }
+    data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    if(data.size() < sizeof(TraceHeader)){
+        std::cerr << path << " is not a trace file\n";
+        return false;
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+    std::uint64_t wordsPerRow = (std::uint64_t(header.cols) + 63) / 64;
+    std::uint64_t occupancyBytes = wordsPerRow * header.rows * 8;
+    bool valid = std::memcmp(header.magic, MAGIC, 4) == 0 && header.version == TraceRecorder::VERSION
+              && header.cols > 0 && header.rows > 0 && std::uint64_t(header.cols) * header.rows <= 0x7fffffffu
+              && header.keyInterval > 0 && sizeof(TraceHeader) + occupancyBytes <= data.size();
+    if(!valid){
+        std::cerr << path << " is not a valid trace file (version " << TraceRecorder::VERSION << ")\n";
+        return false;
+    }
+
+    auto bits = std::make_shared<std::vector<std::uint64_t>>(std::size_t(occupancyBytes / 8));
+    std::memcpy(bits->data(), data.data() + sizeof(TraceHeader), std::size_t(occupancyBytes));
+    occupancy.attach(int(header.cols), int(header.rows), bits->data(), bits);
+    streamBegin = sizeof(TraceHeader) + std::size_t(occupancyBytes);
+
+    if(!index()){
+        std::cerr << path << " is truncated or corrupted\n";
+        return false;
+    }
+    seek(0);
+    return true;
+}
+
+/**
+ * Walks the whole stream once, checking every record and noting where the keyframes and paths are.
+ */
+bool TraceReader::index(){
+    keyframes.clear();
+    discoveries.clear();
+    paths.assign(header.robotCount, std::vector<Mark>());
+    pathCache.assign(header.robotCount, std::vector<int>());
+    pathCacheOffset.assign(header.robotCount, 0);
+
+    long t = 0;
+    std::size_t pos = streamBegin;
+    std::uint64_t robotCount = header.robotCount;
+    std::uint64_t cells = std::uint64_t(header.cols) * header.rows;
+    while(pos < data.size()){
+        std::size_t begin = pos;
+        TraceRecord r = TraceRecord(data[pos++]);
+        switch(r){
+            case TraceRecord::Tick:
+                t += long(getVarint(data, pos));
+                break;
+            case TraceRecord::Key:
+                if(long(getVarint(data, pos)) != t)
+                    return false;
+                keyframes.push_back(Mark{t, begin});
+                for(std::uint64_t i = 0; i < robotCount; i++){
+                    for(int k = 0; k < 4; k++)
+                        getSigned(data, pos);
+                    pos++;
+                }
+                break;
+            case TraceRecord::Velocity:
+                if(getVarint(data, pos) >= robotCount)
+                    return false;
+                getSigned(data, pos);
+                getSigned(data, pos);
+                break;
+            case TraceRecord::Discovery:
+            case TraceRecord::Clear: {
+                std::uint64_t robot = getVarint(data, pos);
+                std::uint64_t tile = getVarint(data, pos);
+                if(robot >= robotCount || tile >= cells)
+                    return false;
+                discoveries.push_back(Discovery{t, int(robot), int(tile), r == TraceRecord::Discovery});
+                break;
+            }
+            case TraceRecord::Path: {
+                std::uint64_t robot = getVarint(data, pos);
+                if(robot >= robotCount)
+                    return false;
+                paths[robot].push_back(Mark{t, begin});
+                std::uint64_t n = getVarint(data, pos);
+                for(std::uint64_t i = 0; i < n && pos <= data.size(); i++)
+                    getVarint(data, pos);
+                break;
+            }
+            case TraceRecord::Goal:
+                if(getVarint(data, pos) >= robotCount)
+                    return false;
+                break;
+            case TraceRecord::End:
+                lastTick = long(getVarint(data, pos));
+                return pos <= data.size() && lastTick >= t;
+            default:
+                return false;
+        }
+        if(pos > data.size())
+            return false;
+    }
+    return false; /// No END record
+}
+
+void TraceReader::decodeKey(std::size_t& pos){
+    pos++;
+    getVarint(data, pos);
+    for(RobotState& s : robots){
+        s.x = std::int32_t(getSigned(data, pos));
+        s.y = std::int32_t(getSigned(data, pos));
+        s.vx = std::int32_t(getSigned(data, pos));
+        s.vy = std::int32_t(getSigned(data, pos));
+        std::uint8_t flags = data[pos++];
+        s.placed = flags & 1;
+        s.goal = flags & 2;
+    }
+}
+
+/**
+ * Applies the records of one tick from 'cursor' (velocities and goals; discoveries and paths are
+ * read through the index) up to the next TICK or END record. A keyframe ends the tick: its offset
+ * is returned so it can be applied after the motion of the tick, otherwise 0.
+ */
+std::size_t TraceReader::applyEvents(){
+    while(cursor < data.size()){
+        TraceRecord r = TraceRecord(data[cursor]);
+        if(r == TraceRecord::Tick || r == TraceRecord::End)
+            return 0;
+        if(r == TraceRecord::Key){
+            std::size_t key = cursor;
+            decodeKey(cursor); /// Skipped here, decoded again by the caller
+            return key;
+        }
+        cursor++;
+        std::uint64_t id = getVarint(data, cursor);
+        if(r == TraceRecord::Velocity){
+            robots[id].vx = std::int32_t(getSigned(data, cursor));
+            robots[id].vy = std::int32_t(getSigned(data, cursor));
+        }
+        else if(r == TraceRecord::Discovery || r == TraceRecord::Clear)
+            getVarint(data, cursor);
+        else if(r == TraceRecord::Path){
+            std::uint64_t n = getVarint(data, cursor);
+            for(std::uint64_t i = 0; i < n; i++)
+                getVarint(data, cursor);
+        }
+        else if(r == TraceRecord::Goal)
+            robots[id].goal = true;
+    }
+    return 0;
+}
+
+void TraceReader::locateNextEvent(){
+    if(cursor < data.size() && TraceRecord(data[cursor]) == TraceRecord::Tick){
+        std::size_t pos = cursor + 1;
+        nextEventTick = writtenTick + long(getVarint(data, pos));
+        nextEventOffset = pos;
+    }
+    else
+        nextEventTick = -1;
+}
+
+bool TraceReader::step(){
+    if(tick >= lastTick)
+        return false;
+    tick++;
+    std::size_t key = 0;
+    if(tick == nextEventTick){
+        writtenTick = tick;
+        cursor = nextEventOffset;
+        key = applyEvents();
+    }
+    for(RobotState& s : robots){
+        s.x += s.vx;
+        s.y += s.vy;
+    }
+    if(key)
+        decodeKey(key);
+    if(tick == writtenTick)
+        locateNextEvent();
+    return true;
+}
+
+void TraceReader::seek(long t){
+    t = std::max(0L, std::min(t, lastTick));
+    auto it = std::upper_bound(keyframes.begin(), keyframes.end(), t,
+                               [](long v, const Mark& m){return v < m.tick;});
+    robots.assign(header.robotCount, RobotState());
+    if(it == keyframes.begin()){
+        /// No keyframe yet: start from the records of tick 0
+        tick = writtenTick = 0;
+        cursor = streamBegin;
+        std::size_t key = applyEvents();
+        if(key)
+            decodeKey(key);
+    }
+    else{
+        --it;
+        tick = writtenTick = it->tick;
+        cursor = it->offset;
+        decodeKey(cursor);
+    }
+    locateNextEvent();
+    while(tick < t)
+        step();
+}
+
+const std::vector<int>& TraceReader::getPath(int robot) const {
+    static const std::vector<int> none;
+    const std::vector<Mark>& marks = paths[robot];
+    auto it = std::upper_bound(marks.begin(), marks.end(), tick,
+                               [](long v, const Mark& m){return v < m.tick;});
+    if(it == marks.begin())
+        return none;
+    --it;
+    if(pathCacheOffset[robot] != it->offset){
+        std::size_t pos = it->offset + 1;
+        getVarint(data, pos);
+        std::uint64_t n = getVarint(data, pos);
+        std::vector<int>& path = pathCache[robot];
+        path.clear();
+        for(std::uint64_t i = 0; i < n; i++)
+            path.push_back(i == 0 ? int(getVarint(data, pos)) : path.back() + int(getSigned(data, pos)));
+        pathCacheOffset[robot] = it->offset;
+    }
+    return pathCache[robot];
+}
+
+std::size_t TraceReader::countDiscoveriesUntil(long t) const {
+    auto it = std::upper_bound(discoveries.begin(), discoveries.end(), t,
+                               [](long v, const Discovery& d){return v < d.tick;});
+    return std::size_t(it - discoveries.begin());
+}
@@ -0,0 +1,65 @@
+#include "WorkStealingPool.h"
+#include <algorithm>
+#include <thread>
+
+WorkStealingPool::WorkStealingPool(int threadCount){
+    if(threadCount <= 0)
+        threadCount = int(std::max(1u, std::thread::hardware_concurrency()));
+    threads = threadCount;
+    for(int i = 0; i < threads; i++)
+        queues.push_back(std::make_unique<Queue>());
+}
+
+bool WorkStealingPool::pop(int worker, int& task){
+    Queue& q = *queues[worker];
+    std::lock_guard<std::mutex> lock(q.mutex);
+    if(q.tasks.empty())
+        return false;
+    task = q.tasks.back();
+    q.tasks.pop_back();
+    return true;
+}
+
+/**
+ * Visits the other workers in turn, starting with the next one, and takes the oldest task of the first non-empty deque.
+ */
+bool WorkStealingPool::steal(int thief, int& task){
+    for(int k = 1; k < threads; k++){
+        Queue& q = *queues[(thief + k) % threads];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if(q.tasks.empty())
+            continue;
+        task = q.tasks.front();
+        q.tasks.pop_front();
+        steals.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+void WorkStealingPool::workerLoop(int worker, const std::function<void(int, int)>& f){
+    int task;
+    /// No task is added during a run: once every deque is seen empty, the worker is done
+    while(pop(worker, task) || steal(worker, task))
+        f(task, worker);
+}
+
+void WorkStealingPool::run(int n, const std::function<void(int, int)>& f){
+    steals.store(0, std::memory_order_relaxed);
+    for(int w = 0; w < threads; w++){
+        /// Worker w owns [n*w/threads, n*(w+1)/threads); it pops them from the back, thieves take the front
+        long begin = long(n) * w / threads;
+        long end = long(n) * (w + 1) / threads;
+        Queue& q = *queues[w];
+        q.tasks.clear();
+        for(long i = end - 1; i >= begin; i--)
+            q.tasks.push_back(int(i));
+    }
+
+    std::vector<std::thread> workers;
+    for(int w = 1; w < threads; w++)
+        workers.emplace_back(&WorkStealingPool::workerLoop, this, w, std::cref(f));
+    workerLoop(0, f);
+    for(auto& t : workers)
+        t.join();
+}
@@ -0,0 +1,93 @@
+#include "WorkerPool.h"
+#include <algorithm>
+
+WorkerPool::WorkerPool(int threads){
+    if(threads <= 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    for(int i = 1; i < threads; i++)
+        workers.emplace_back(&WorkerPool::workerLoop, this);
+}
+
+WorkerPool::~WorkerPool(){
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for(auto& t : workers)
+        t.join();
+}
+
+/**
+ * Takes chunks of the current loop until none is left.
+ */
+void WorkerPool::runChunks(){
+    while(true){
+        int begin = next.fetch_add(chunk, std::memory_order_relaxed);
+        if(begin >= count)
+            return;
+        int end = std::min(count, begin + chunk);
+        for(int i = begin; i < end; i++)
+            (*body)(i);
+    }
+}
+
+void WorkerPool::workerLoop(){
+    unsigned seen = 0;
+    while(true){
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&]{ return stopping || generation != seen; });
+            if(stopping)
+                return;
+            seen = generation;
+            //// The loop needs fewer workers, or the caller already finished it
+            if(slots == 0)
+                continue;
+            slots--;
+            busy++;
+        }
+        runChunks();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if(--busy == 0)
+                done.notify_one();
+        }
+    }
+}
+
+void WorkerPool::parallelFor(int n, const std::function<void(int)>& f){
+    if(n <= 0)
+        return;
+    /// A few items cost less than waking the workers
+    if(workers.empty() || n < INLINE_PER_THREAD * getThreadCount()){
+        for(int i = 0; i < n; i++)
+            f(i);
+        return;
+    }
+    int helpers;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        body = &f;
+        count = n;
+        /// About 8 chunks per thread: small enough to balance uneven robots, large enough to keep the counter cold
+        chunk = std::max(1, n / (getThreadCount() * 8));
+        next.store(0, std::memory_order_relaxed);
+        /// The caller takes a chunk too: one worker per other chunk at most
+        helpers = std::min(int(workers.size()), (n + chunk - 1) / chunk - 1);
+        slots = helpers;
+        busy = 0;
+        generation++;
+    }
+    if(helpers == int(workers.size()))
+        wake.notify_all();
+    else
+        for(int i = 0; i < helpers; i++)
+            wake.notify_one();
+    runChunks();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    slots = 0; /// Workers waking from now on have nothing left to do
+    done.wait(lock, [&]{ return busy == 0; });
+    body = nullptr;
+}
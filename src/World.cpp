@@ -0,0 +1,134 @@
+#include "World.h"
+#include <algorithm>
+
+World::World(Map * trueMap, int threads)
+    : map(trueMap), prior(trueMap->cloneBelief()), pool(threads), teamPlanner(&trueMap->getGrid(), &pool) {
+}
+
+Robot& World::addRobot(int startTile, int goalTile, PlannerType planner){
+    int cols = map->getCols();
+    robots.push_back(std::make_unique<Robot>(map, 0, 0, 25, false, &prior, &states));
+    Robot& robot = *robots.back();
+    robot.setPathHighlight(false);
+    robot.setPlannerType(planner);
+    robot.setMetrics(metrics, int(robots.size()) - 1);
+    robot.placeRobot(startTile % cols, startTile / cols);
+    robot.setStartTile(startTile);
+    robot.setEndTile(goalTile);
+    robot.setCanRunAlgo(true);
+    return robot;
+}
+
+const MultiAgentStats& World::planCooperative(MultiAgentMode mode){
+    std::vector<int> starts, goals;
+    for(const auto& r : robots){
+        starts.push_back(r->getCurrentTile());
+        goals.push_back(r->getEndTile());
+    }
+    const std::vector<std::vector<int>>& paths = teamPlanner.plan(starts, goals, mode);
+    for(std::size_t i = 0; i < robots.size(); i++)
+        robots[i]->followPlan(paths[i]);
+    return teamPlanner.getLastStats();
+}
+
+/**
+ * One tick: robots are independent, so the full updates are split over the pool without any locking.
+ */
+void World::step(){
+    states.advance(map->getGrid(), pending);
+    pool.parallelFor(int(pending.size()), [this](int i){
+        robots[pending[i]]->update();
+    });
+    tick++;
+}
+
+long World::run(long maxTicks){
+    if(eventDriven)
+        return runEvents(maxTicks);
+    long done = 0;
+    while(done < maxTicks && getRunningCount() > 0){
+        step();
+        done++;
+    }
+    return done;
+}
+
+/**
+ * Events are keyed by their tick relative to the start of the call. A robot cruising for more than
+ * BucketQueue::SPAN ticks is woken early, does its moves so far, and is keyed again.
+ * Robots woken on the same tick are independent, so their full updates run in parallel as in step().
+ */
+long World::runEvents(long maxTicks){
+    const GridGraph& grid = map->getGrid();
+    long start = tick;
+    long end = tick + maxTicks;
+    clocks.assign(robots.size(), tick);
+    events.clear();
+    auto schedule = [&](int i, long now){
+        long due = clocks[i] + 1 + std::min<long>(states.cruiseTicks(i, grid), BucketQueue::SPAN);
+        events.push(unsigned(std::min<long>(due, now + BucketQueue::SPAN - 1) - start), i);
+    };
+    for(int i = 0; i < int(robots.size()); i++)
+        if(robots[i]->isRunning())
+            schedule(i, tick);
+
+    while(!events.empty()){
+        unsigned key = events.topKey();
+        long now = start + long(key);
+        if(now > end)
+            break;
+        //// Not topKey() again: it would move the cursor past the keys pushed for the next ticks
+        pending.clear();
+        for(std::size_t n = events.countAt(key); n > 0; n--)
+            pending.push_back(events.pop(key));
+
+        //// Catch up on the moves before this tick; a robot woken early only moves
+        std::size_t updates = 0;
+        for(int i : pending){
+            states.skip(i, now - 1 - clocks[i]);
+            clocks[i] = now - 1;
+            if(states.cruiseTicks(i, grid) > 0){
+                states.skip(i, 1);
+                clocks[i] = now;
+                schedule(i, now);
+            }
+            else
+                pending[updates++] = i;
+        }
+        pending.resize(updates);
+
+        pool.parallelFor(int(pending.size()), [this](int k){
+            robots[pending[k]]->update();
+        });
+        for(int i : pending){
+            clocks[i] = now;
+            if(robots[i]->isRunning())
+                schedule(i, now);
+        }
+        tick = now;
+    }
+
+    //// Robots still running are between two events: bring them to the last tick
+    if(!events.empty()){
+        for(std::size_t i = 0; i < robots.size(); i++)
+            if(robots[i]->isRunning())
+                states.skip(int(i), end - clocks[i]);
+        tick = end;
+    }
+    return tick - start;
+}
+
+int World::getRunningCount() const {
+    int running = 0;
+    for(const auto& r : robots)
+        if(r->isRunning())
+            running++;
+    return running;
+}
+
+std::size_t World::getBeliefMemoryBytes() const {
+    std::size_t bytes = prior.getGrid().getMemoryBytes();
+    for(const auto& r : robots)
+        bytes += r->getRobotMap()->getGrid().getMemoryBytes();
+    return bytes;
+}
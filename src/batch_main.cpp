@@ -0,0 +1,355 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "Map.h"
+#include "Robot.h"
+#include "PlannerType.h"
+#include "ScenarioGenerator.h"
+#include "WorkStealingPool.h"
+
+namespace {
+
+/// Maps with more tiles than this are tile-less (see Map::fromOccupancy)
+const long TILE_CELLS = 1L << 20;
+
+/**
+ * One run: a scenario solved by one planner.
+ */
+struct Job {
+    int scenario; /// Index of the scenario (its seed is baseSeed + scenario)
+    ScenarioSpec spec;
+    PlannerType planner;
+};
+
+/**
+ * Sensing options shared by every run.
+ */
+struct SensorSetup {
+    int rays = 0;
+    int range = 0;
+    BeliefModel belief = BeliefModel::Binary;
+    double falseHits = 0.0;
+    double missedHits = 0.0;
+};
+
+/**
+ * Outcome of a job, one row of the summary file.
+ */
+struct Outcome {
+    int start = -1;
+    int goal = -1;
+    bool generated = false; /// False if the map had no connected start and goal
+    bool reached = false;
+    long ticks = 0; /// Updates done (ticks to goal if reached)
+    int replans = 0;
+    long expanded = 0; /// Planner nodes expanded over the whole run
+    double wallMs = 0; /// Generation excluded
+    int worker = 0; /// Thread that ran the job
+};
+
+bool parsePlanner(const std::string& name, PlannerType& planner){
+    if(name == "dijkstra") planner = PlannerType::Dijkstra;
+    else if(name == "astar") planner = PlannerType::AStar;
+    else if(name == "jps") planner = PlannerType::JumpPoint;
+    else if(name == "dstar") planner = PlannerType::DStarLite;
+    else if(name == "hpa") planner = PlannerType::Hierarchical;
+    else if(name == "dial") planner = PlannerType::Dial;
+    else if(name == "alt") planner = PlannerType::Landmarks;
+    else return false;
+    return true;
+}
+
+std::vector<std::string> split(const std::string& list){
+    std::vector<std::string> items;
+    std::stringstream in(list);
+    std::string item;
+    while(std::getline(in, item, ','))
+        if(!item.empty())
+            items.push_back(item);
+    return items;
+}
+
+/**
+ * Generates the scenario of a job and runs one robot on it, like RobotSimHeadless does.
+ * Event-driven runs (Robot::run) give the same outcome as stepping update() tick by tick.
+ */
+Outcome runJob(const Job& job, long maxTicks, const SensorSetup& sensing, bool events){
+    Outcome out;
+    GridGraph grid;
+    if(!ScenarioGenerator::generate(job.spec, grid, out.start, out.goal))
+        return out;
+    out.generated = true;
+
+    Map map;
+    if(long(grid.size()) > TILE_CELLS)
+        map = Map::fromOccupancy(grid);
+    else{
+        map = Map::fromGrid(grid.getCols(), grid.getRows());
+        for(int i = 0; i < grid.size(); i++)
+            if(grid.isBlocked(i))
+                map.setTileType(i, TileType::Obstacle);
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    int cols = grid.getCols();
+    Robot robot(&map, 0, 0, 25, false);
+    robot.setPathHighlight(false);
+    robot.setPlannerType(job.planner);
+    robot.setRangeScan(sensing.rays, sensing.range);
+    robot.setScanNoise(sensing.falseHits, sensing.missedHits, job.spec.seed);
+    robot.setBeliefModel(sensing.belief);
+    robot.placeRobot(out.start % cols, out.start / cols);
+    robot.setStartTile(out.start);
+    robot.setEndTile(out.goal);
+    robot.setCanRunAlgo(true);
+    /// Default tick budget: 100 ticks cross a tile, allow every free tile to be crossed once
+    long budget = maxTicks > 0 ? maxTicks : 100L * grid.size() + 1000;
+    if(events)
+        robot.run(budget);
+    else
+        while(robot.isRunning() && robot.getTicks() < budget)
+            robot.update();
+    out.wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    out.reached = robot.hasReachedGoal();
+    out.ticks = robot.getTicks();
+    out.replans = robot.getReplans();
+    out.expanded = robot.getPlannerTotals().expanded;
+    return out;
+}
+
+void writeCsv(std::ostream& out, const std::vector<Job>& jobs, const std::vector<Outcome>& outcomes){
+    out << "scenario,kind,cols,rows,density,seed,start,goal,planner,reached,ticks,replans,expanded,wall_ms,worker\n";
+    for(std::size_t i = 0; i < jobs.size(); i++){
+        const Job& j = jobs[i];
+        const Outcome& o = outcomes[i];
+        out << j.scenario << "," << mapKindToString(j.spec.kind) << "," << j.spec.cols << "," << j.spec.rows << ","
+            << j.spec.density << "," << j.spec.seed << "," << o.start << "," << o.goal << ","
+            << plannerTypeToString(j.planner) << "," << (o.reached ? 1 : 0) << "," << o.ticks << ","
+            << o.replans << "," << o.expanded << "," << o.wallMs << "," << o.worker << "\n";
+    }
+}
+
+void writeJson(std::ostream& out, const std::vector<Job>& jobs, const std::vector<Outcome>& outcomes){
+    out << "{\n  \"runs\": [\n";
+    for(std::size_t i = 0; i < jobs.size(); i++){
+        const Job& j = jobs[i];
+        const Outcome& o = outcomes[i];
+        out << "    {\"scenario\": " << j.scenario << ", \"kind\": \"" << mapKindToString(j.spec.kind)
+            << "\", \"cols\": " << j.spec.cols << ", \"rows\": " << j.spec.rows << ", \"density\": " << j.spec.density
+            << ", \"seed\": " << j.spec.seed << ", \"start\": " << o.start << ", \"goal\": " << o.goal
+            << ", \"planner\": \"" << plannerTypeToString(j.planner) << "\", \"reached\": " << (o.reached ? "true" : "false")
+            << ", \"ticks\": " << o.ticks << ", \"replans\": " << o.replans << ", \"expanded\": " << o.expanded
+            << ", \"wall_ms\": " << o.wallMs << ", \"worker\": " << o.worker << "}"
+            << (i + 1 < jobs.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+/**
+ * Aggregate of the runs of one planner on one map kind.
+ */
+struct Aggregate {
+    int runs = 0;
+    int reached = 0;
+    std::vector<long> ticksToGoal; /// Successful runs only
+    long replans = 0;
+    double wallMs = 0;
+};
+
+long percentile(std::vector<long> v, double p){
+    if(v.empty())
+        return 0;
+    std::size_t k = std::min(v.size() - 1, std::size_t(p * (v.size() - 1) + 0.5));
+    std::nth_element(v.begin(), v.begin() + k, v.end());
+    return v[k];
+}
+
+void printAggregates(const std::vector<Job>& jobs, const std::vector<Outcome>& outcomes){
+    std::map<std::pair<std::string, std::string>, Aggregate> groups; /// (planner, kind), kind "all" for the total
+    for(std::size_t i = 0; i < jobs.size(); i++){
+        if(!outcomes[i].generated)
+            continue;
+        std::string planner = plannerTypeToString(jobs[i].planner);
+        for(const std::string& kind : {std::string(mapKindToString(jobs[i].spec.kind)), std::string("all")}){
+            Aggregate& a = groups[{planner, kind}];
+            a.runs++;
+            a.replans += outcomes[i].replans;
+            a.wallMs += outcomes[i].wallMs;
+            if(outcomes[i].reached){
+                a.reached++;
+                a.ticksToGoal.push_back(outcomes[i].ticks);
+            }
+        }
+    }
+    std::cout << std::left << std::setw(14) << "planner" << std::setw(8) << "kind" << std::right
+              << std::setw(7) << "runs" << std::setw(10) << "success" << std::setw(12) << "ticks p50"
+              << std::setw(12) << "ticks p90" << std::setw(10) << "replans" << std::setw(12) << "wall ms\n";
+    for(const auto& g : groups){
+        const Aggregate& a = g.second;
+        std::cout << std::left << std::setw(14) << g.first.first << std::setw(8) << g.first.second << std::right
+                  << std::setw(7) << a.runs
+                  << std::setw(9) << std::fixed << std::setprecision(1) << 100.0 * a.reached / a.runs << "%"
+                  << std::setw(12) << percentile(a.ticksToGoal, 0.5) << std::setw(12) << percentile(a.ticksToGoal, 0.9)
+                  << std::setw(10) << std::setprecision(2) << double(a.replans) / a.runs
+                  << std::setw(11) << std::setprecision(2) << a.wallMs / a.runs << "\n";
+    }
+}
+
+}
+
+/**
+ * Batch entry point: generates scenarios and runs them headless on every core.
+ *
+ * Usage: RobotSimBatch [--count N] [--kinds LIST] [--sizes LIST] [--density P] [--seed S]
+ *                      [--planners LIST] [--ticks N] [--threads N] [--rays N] [--range N] [--out FILE]
+ *                      [--belief MODEL] [--false-hits P] [--missed-hits P] [--events 0|1]
+ *  - count:    number of scenarios (default 100)
+ *  - kinds:    map kinds used in turn, among open, random, maze, rooms (default random,maze,rooms)
+ *  - sizes:    map sizes used in turn, e.g. 16x12,64x48 (default 16x12,64x48)
+ *  - density:  obstacle probability of random and rooms maps (default 0.2)
+ *  - seed:     seed of scenario 0; scenario i uses seed+i (default 1)
+ *  - planners: every scenario is run with each of them (default dstar), same names as RobotSimHeadless
+ *  - ticks:    tick budget per run (default 0 = 100 per tile of the map)
+ *  - threads:  worker threads (default 0 = one per hardware thread)
+ *  - rays/range: range scanner of the robot (default 0 = only the adjacent-tile sensors)
+ *  - out:      summary file with one row per run, as CSV (.csv) or JSON (any other extension)
+ *  - belief:   binary or logodds (default binary), see Robot::setBeliefModel
+ *  - false-hits/missed-hits: range scanner noise (see RayScanner::setNoise), seeded by the scenario seed
+ *  - events:   0 steps every tick instead of jumping from one robot event to the next (default 1, same results)
+ *
+ * Each scenario has a seeded start and goal in the same connected region, so every run can succeed.
+ * Results only depend on the options, not on the number of threads.
+ */
+int main(int argc, char** argv)
+{
+    int count = 100;
+    std::vector<MapKind> kinds{MapKind::Random, MapKind::Maze, MapKind::Rooms};
+    std::vector<std::pair<int, int>> sizes{{16, 12}, {64, 48}};
+    double density = 0.2;
+    unsigned seed = 1;
+    std::vector<PlannerType> planners{PlannerType::DStarLite};
+    long maxTicks = 0;
+    int threads = 0;
+    SensorSetup sensing;
+    bool events = true;
+    std::string outPath;
+
+    for(int i = 1; i + 1 < argc; i += 2){
+        if(std::strcmp(argv[i], "--count") == 0) count = std::atoi(argv[i+1]);
+        else if(std::strcmp(argv[i], "--density") == 0) density = std::atof(argv[i+1]);
+        else if(std::strcmp(argv[i], "--seed") == 0) seed = unsigned(std::atol(argv[i+1]));
+        else if(std::strcmp(argv[i], "--ticks") == 0) maxTicks = std::atol(argv[i+1]);
+        else if(std::strcmp(argv[i], "--threads") == 0) threads = std::atoi(argv[i+1]);
+        else if(std::strcmp(argv[i], "--rays") == 0) sensing.rays = std::atoi(argv[i+1]);
+        else if(std::strcmp(argv[i], "--range") == 0) sensing.range = std::atoi(argv[i+1]);
+        else if(std::strcmp(argv[i], "--false-hits") == 0) sensing.falseHits = std::atof(argv[i+1]);
+        else if(std::strcmp(argv[i], "--missed-hits") == 0) sensing.missedHits = std::atof(argv[i+1]);
+        else if(std::strcmp(argv[i], "--belief") == 0){
+            if(!beliefModelFromString(argv[i+1], sensing.belief)){
+                std::cerr << "Unknown belief model " << argv[i+1] << "\n";
+                return 1;
+            }
+        }
+        else if(std::strcmp(argv[i], "--out") == 0) outPath = argv[i+1];
+        else if(std::strcmp(argv[i], "--events") == 0) events = std::atoi(argv[i+1]) != 0;
+        else if(std::strcmp(argv[i], "--kinds") == 0){
+            kinds.clear();
+            for(const std::string& name : split(argv[i+1])){
+                MapKind k;
+                if(!mapKindFromString(name, k)){
+                    std::cerr << "Unknown map kind " << name << "\n";
+                    return 1;
+                }
+                kinds.push_back(k);
+            }
+        }
+        else if(std::strcmp(argv[i], "--sizes") == 0){
+            sizes.clear();
+            for(const std::string& size : split(argv[i+1])){
+                int c = 0, r = 0;
+                char x = 0;
+                std::stringstream in(size);
+                if(!(in >> c >> x >> r) || x != 'x' || c <= 0 || r <= 0){
+                    std::cerr << "Bad size " << size << " (expected COLSxROWS)\n";
+                    return 1;
+                }
+                sizes.push_back({c, r});
+            }
+        }
+        else if(std::strcmp(argv[i], "--planners") == 0){
+            planners.clear();
+            for(const std::string& name : split(argv[i+1])){
+                PlannerType p;
+                if(!parsePlanner(name, p)){
+                    std::cerr << "Unknown planner " << name << "\n";
+                    return 1;
+                }
+                planners.push_back(p);
+            }
+        }
+        else{
+            std::cerr << "Unknown option " << argv[i] << "\n";
+            return 1;
+        }
+    }
+    if(count <= 0 || kinds.empty() || sizes.empty() || planners.empty()){
+        std::cerr << "Nothing to run\n";
+        return 1;
+    }
+
+    /// Scenario i: kind i % kinds, size (i / kinds) % sizes, seed + i; every planner runs every scenario
+    std::vector<Job> jobs;
+    for(int i = 0; i < count; i++){
+        ScenarioSpec spec;
+        spec.kind = kinds[std::size_t(i) % kinds.size()];
+        const auto& size = sizes[(std::size_t(i) / kinds.size()) % sizes.size()];
+        spec.cols = size.first;
+        spec.rows = size.second;
+        spec.density = density;
+        spec.seed = seed + unsigned(i);
+        for(PlannerType p : planners)
+            jobs.push_back(Job{i, spec, p});
+    }
+
+    WorkStealingPool pool(threads);
+    std::vector<Outcome> outcomes(jobs.size());
+    auto begin = std::chrono::steady_clock::now();
+    pool.run(int(jobs.size()), [&](int j, int worker){
+        outcomes[j] = runJob(jobs[j], maxTicks, sensing, events);
+        outcomes[j].worker = worker;
+    });
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+    int skipped = 0;
+    for(const Outcome& o : outcomes)
+        skipped += o.generated ? 0 : 1;
+    std::cout << "Runs: " << jobs.size() << "  threads: " << pool.getThreadCount() << "  steals: " << pool.getSteals()
+              << "  wall time: " << ms << " ms";
+    if(skipped > 0)
+        std::cout << "  skipped (no connected start/goal): " << skipped;
+    std::cout << "\n";
+    printAggregates(jobs, outcomes);
+
+    if(!outPath.empty()){
+        std::ofstream out(outPath);
+        if(!out){
+            std::cerr << "Cannot write " << outPath << "\n";
+            return 1;
+        }
+        bool csv = outPath.size() > 4 && outPath.compare(outPath.size() - 4, 4, ".csv") == 0;
+        if(csv)
+            writeCsv(out, jobs, outcomes);
+        else
+            writeJson(out, jobs, outcomes);
+        std::cout << "Summary written to " << outPath << "\n";
+    }
+    return 0;
+}
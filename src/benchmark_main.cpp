@@ -0,0 +1,417 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+#include "Map.h"
+#include "Robot.h"
+#include "RobotStates.h"
+#include "Sensor.h"
+#include "DStarLite.h"
+#include "JumpPointSearch.h"
+#include "HierarchicalPlanner.h"
+#include "ScenarioGenerator.h"
+#include "OccupancyGrid.h"
+#include "RayScanner.h"
+#include "MultiAgentPlanner.h"
+#include "WorkerPool.h"
+
+/// ------------------------ Allocation counter ------------------------
+/// Every heap allocation of the process goes through these replacements, so each benchmark
+/// can report how many allocations one operation does.
+namespace {
+std::atomic<long> allocations{0};
+}
+
+void * operator new(std::size_t size){
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if(void * p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+void * operator new[](std::size_t size){return operator new(size);}
+void operator delete(void * p) noexcept {std::free(p);}
+void operator delete[](void * p) noexcept {std::free(p);}
+void operator delete(void * p, std::size_t) noexcept {std::free(p);}
+void operator delete[](void * p, std::size_t) noexcept {std::free(p);}
+
+namespace {
+
+/// Maps with more tiles than this skip the benchmarks that store data per tile and per edge/landmark
+const long HEAVY_CELLS = 1L << 22;
+/// Maps with more tiles than this are created without Tile objects (see Map::fromOccupancy)
+const long TILE_CELLS = 1L << 20;
+
+/**
+ * One line of the report.
+ */
+struct Result {
+    std::string map; /// Map family
+    int cols;
+    int rows;
+    std::string op; /// Benchmarked operation
+    long iterations; /// Operations timed
+    double nsPerOp;
+    double expandedPerOp; /// Planner nodes expanded per operation (0 if not a search)
+    double allocsPerOp; /// Heap allocations per operation
+};
+
+/**
+ * Generated map: occupancy plus a free start and goal far apart.
+ */
+struct Scenario {
+    std::string name;
+    GridGraph grid;
+    int start = -1;
+    int goal = -1;
+};
+
+Scenario makeScenario(const std::string& name, int cols, int rows){
+    Scenario s;
+    s.name = name;
+    if(name == "random")
+        s.grid = ScenarioGenerator::randomGrid(cols, rows, 0.2, 1);
+    else if(name == "maze")
+        s.grid = ScenarioGenerator::mazeGrid(cols, rows, 1);
+    else
+        s.grid = GridGraph(cols, rows);
+    /// First and last free tiles: opposite corners (or close to them)
+    s.start = 0;
+    while(s.start < cols * rows && s.grid.isBlocked(s.start))
+        s.start++;
+    s.goal = cols * rows - 1;
+    while(s.goal > s.start && s.grid.isBlocked(s.goal))
+        s.goal--;
+    return s;
+}
+
+/**
+ * Builds the Map of a scenario: with tiles (like the viewer) on small grids, tile-less on large ones.
+ */
+Map makeMap(const Scenario& s){
+    long cells = long(s.grid.getCols()) * s.grid.getRows();
+    if(cells > TILE_CELLS)
+        return Map::fromOccupancy(s.grid);
+    Map m = Map::fromGrid(s.grid.getCols(), s.grid.getRows());
+    for(int i = 0; i < s.grid.size(); i++)
+        if(s.grid.isBlocked(i))
+            m.setTileType(i, TileType::Obstacle);
+    return m;
+}
+
+class Runner {
+    private:
+        double minSeconds; /// Each benchmark repeats its operation for at least this long
+        std::string filter; /// Only operations whose name contains it run
+        std::vector<Result> results;
+
+    public:
+        Runner(double seconds, const std::string& only) : minSeconds(seconds), filter(only) {}
+
+        bool enabled(const std::string& op) const {return filter.empty() || op.find(filter) != std::string::npos;}
+
+        /**
+         * Times body until minSeconds have passed.
+         * body returns the nodes it expanded and sets 'ops' to the operations it did (1 by default,
+         * more for very short operations run in batches, 0 when there is nothing left to do).
+         */
+        void run(const Scenario& s, const std::string& op, const std::function<long(long& ops)>& body){
+            if(!enabled(op))
+                return;
+            long iterations = 0;
+            long expanded = 0;
+            long allocs = 0;
+            double seconds = 0;
+            while(seconds < minSeconds){
+                long ops = 1;
+                long before = allocations.load(std::memory_order_relaxed);
+                auto begin = std::chrono::steady_clock::now();
+                expanded += body(ops);
+                auto end = std::chrono::steady_clock::now();
+                if(ops == 0)
+                    break;
+                allocs += allocations.load(std::memory_order_relaxed) - before;
+                seconds += std::chrono::duration<double>(end - begin).count();
+                iterations += ops;
+            }
+            if(iterations == 0)
+                return;
+            Result r{s.name, s.grid.getCols(), s.grid.getRows(), op, iterations,
+                     seconds * 1e9 / iterations, double(expanded) / iterations, double(allocs) / iterations};
+            std::cout << std::left << std::setw(8) << r.map << std::setw(12) << (std::to_string(r.cols) + "x" + std::to_string(r.rows))
+                      << std::setw(22) << r.op << std::right << std::setw(16) << std::fixed << std::setprecision(1) << r.nsPerOp << " ns/op"
+                      << std::setw(14) << std::setprecision(1) << r.expandedPerOp << " exp/op"
+                      << std::setw(12) << std::setprecision(2) << r.allocsPerOp << " allocs/op"
+                      << std::setw(10) << r.iterations << " iters\n";
+            results.push_back(r);
+        }
+
+        const std::vector<Result>& getResults() const {return results;}
+};
+
+void writeCsv(std::ostream& out, const std::vector<Result>& results){
+    out << "map,cols,rows,op,iterations,ns_per_op,expanded_per_op,allocs_per_op\n";
+    for(const Result& r : results)
+        out << r.map << "," << r.cols << "," << r.rows << "," << r.op << "," << r.iterations << ","
+            << r.nsPerOp << "," << r.expandedPerOp << "," << r.allocsPerOp << "\n";
+}
+
+void writeJson(std::ostream& out, const std::vector<Result>& results){
+    out << "{\n  \"benchmarks\": [\n";
+    for(std::size_t i = 0; i < results.size(); i++){
+        const Result& r = results[i];
+        out << "    {\"map\": \"" << r.map << "\", \"cols\": " << r.cols << ", \"rows\": " << r.rows
+            << ", \"op\": \"" << r.op << "\", \"iterations\": " << r.iterations
+            << ", \"ns_per_op\": " << r.nsPerOp << ", \"expanded_per_op\": " << r.expandedPerOp
+            << ", \"allocs_per_op\": " << r.allocsPerOp << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+/**
+ * Seeded team of 'count' agents: distinct free start tiles and distinct free goal tiles.
+ */
+void makeTeam(const GridGraph& grid, int count, std::vector<int>& starts, std::vector<int>& goals){
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<int> anyTile(0, grid.size() - 1);
+    std::vector<char> taken(std::size_t(grid.size()) * 2, 0);
+    auto pick = [&](int kind){
+        int t = anyTile(rng);
+        while(grid.isBlocked(t) || taken[std::size_t(kind) * grid.size() + t])
+            t = anyTile(rng);
+        taken[std::size_t(kind) * grid.size() + t] = 1;
+        return t;
+    };
+    starts.clear();
+    goals.clear();
+    for(int i = 0; i < count; i++){
+        starts.push_back(pick(0));
+        goals.push_back(pick(1));
+    }
+}
+
+/**
+ * Runs every benchmark on one scenario.
+ */
+void benchmarkScenario(Runner& runner, const Scenario& s, WorkerPool& pool){
+    long cells = long(s.grid.getCols()) * s.grid.getRows();
+    bool heavy = cells > HEAVY_CELLS;
+    Map map = makeMap(s);
+    int start = s.start;
+    int goal = s.goal;
+
+    if(!heavy)
+        runner.run(s, "buildGraph", [&](long&){map.buildGraph(); return 0L;});
+    runner.run(s, "cloneStructure", [&](long&){Map clone = map.cloneStructureWithoutObstacles(); return 0L;});
+    runner.run(s, "cloneBelief", [&](long&){Map clone = map.cloneBelief(); return 0L;});
+
+    runner.run(s, "dijkstra", [&](long&){map.dijkstra(start, goal); return map.getLastSearchStats().expanded;});
+    runner.run(s, "aStar", [&](long&){map.aStar(start, goal); return map.getLastSearchStats().expanded;});
+    if(!heavy){
+        runner.run(s, "landmarks(8)", [&](long&){map.preprocessLandmarks(8); return 0L;});
+        if(runner.enabled("aStarLandmarks") && !map.getLandmarks().isBuilt())
+            map.preprocessLandmarks(8);
+        runner.run(s, "aStarLandmarks", [&](long&){map.aStarLandmarks(start, goal); return map.getLastSearchStats().expanded;});
+
+        /// Queries cycling over the 16 pairs of 4 docks and 4 goals on the static map, without and with the path cache
+        if(runner.enabled("dockQueries")){
+            std::vector<int> docks, goals;
+            makeTeam(s.grid, 4, docks, goals);
+            Map depot = map;
+            if(!depot.getLandmarks().isBuilt())
+                depot.preprocessLandmarks(8);
+            long query = 0;
+            auto nextQuery = [&](long&){
+                int k = int(query++ % 16);
+                depot.aStarLandmarks(docks[k / 4], goals[k % 4]);
+                return depot.getLastSearchStats().expanded;
+            };
+            runner.run(s, "dockQueries", nextQuery);
+            depot.setPathCacheSize(16);
+            runner.run(s, "dockQueriesCached", nextQuery);
+        }
+    }
+
+    /// Integer costs: bucket queue against the heap, both stopping on the goal (A* with zeroHeuristic is that heap search)
+    runner.run(s, "dial", [&](long&){map.dial(start, goal); return map.getLastSearchStats().expanded;});
+    runner.run(s, "heapEarlyExit", [&](long&){map.aStar(start, goal, zeroHeuristic); return map.getLastSearchStats().expanded;});
+    if(runner.enabled("Cost")){
+        /// Same searches over terrain costs (1 to 9) plus a penalty near obstacles
+        Map weighted = map;
+        weighted.setCosts(ScenarioGenerator::terrainCosts(s.grid.getCols(), s.grid.getRows(), 1));
+        weighted.addObstaclePenalty(2, 3);
+        runner.run(s, "dialCost", [&](long&){weighted.dial(start, goal); return weighted.getLastSearchStats().expanded;});
+        runner.run(s, "heapEarlyExitCost", [&](long&){weighted.aStar(start, goal, zeroHeuristic); return weighted.getLastSearchStats().expanded;});
+        runner.run(s, "aStarCost", [&](long&){weighted.aStar(start, goal); return weighted.getLastSearchStats().expanded;});
+    }
+
+    JumpPointSearch jps;
+    runner.run(s, "jumpPoint", [&](long&){jps.findPath(map.getGrid(), start, goal); return jps.getLastStats().expanded;});
+
+    DStarLite dstar(&map);
+    runner.run(s, "dstarLite", [&](long&){dstar.reset(start, goal); dstar.plan(start); return dstar.getFullSearchStats().expanded;});
+
+    if(runner.enabled("hpa")){
+        HierarchicalPlanner hpa(&map);
+        runner.run(s, "hpaBuild", [&](long&){hpa.setClusterSize(16); hpa.findPath(start, goal); return hpa.getLastStats().expanded;});
+        runner.run(s, "hpaQuery", [&](long&){hpa.findPath(start, goal); return hpa.getLastStats().expanded;});
+    }
+
+    /// Team planning against fleet size, on the pool. The distance fields are built before timing (they are
+    /// kept while the goals do not change), so an operation is a replanning of the whole team.
+    if(runner.enabled("mapf") && !heavy && s.grid.size() >= 64 * 48){
+        MultiAgentPlanner team(&s.grid, &pool);
+        std::vector<int> starts, goals;
+        for(int agents : {25, 50, 100, 200}){
+            makeTeam(s.grid, agents, starts, goals);
+            team.plan(starts, goals);
+            runner.run(s, "mapfPrioritized(" + std::to_string(agents) + ")", [&](long&){
+                team.plan(starts, goals);
+                return team.getLastStats().lowLevel.expanded;
+            });
+        }
+        for(int agents : {4, 8}){
+            makeTeam(s.grid, agents, starts, goals);
+            team.plan(starts, goals, MultiAgentMode::ConflictBased);
+            runner.run(s, "mapfCbs(" + std::to_string(agents) + ")", [&](long&){
+                team.plan(starts, goals, MultiAgentMode::ConflictBased);
+                return team.getLastStats().lowLevel.expanded;
+            });
+        }
+    }
+
+    /// Sensor and robot: the robot starts on the start tile, heading to the goal
+    Robot robot(&map, 0, 0, 25, false);
+    robot.setPathHighlight(false);
+    robot.placeRobot(start % s.grid.getCols(), start / s.grid.getCols());
+    robot.setStartTile(start);
+    robot.setEndTile(goal);
+    Sensor sensor(Direction::Right, &robot, &map);
+    runner.run(s, "sensorActive", [&](long& ops){
+        static volatile long hits = 0; /// Keeps the reads from being optimized away
+        ops = 1000;
+        for(long i = 0; i < ops; i++){
+            sensor.active();
+            hits = hits + (sensor.getdetectionChecked() ? 1 : 0);
+        }
+        return 0L;
+    });
+
+    /// Log-odds belief: one 32-ray scan of range 8 from the start, then the batch update alone (kernel)
+    if(runner.enabled("logOdds")){
+        RayScanner scanner(32, 8);
+        OccupancyGrid occupancy;
+        occupancy.reset(s.grid.getCols(), s.grid.getRows(), map.getGrid().isChunked());
+        GridGraph view = s.grid;
+        std::vector<int> crossed, hits, flipped;
+        runner.run(s, "logOddsScan", [&](long&){
+            scanner.traceRays(s.grid, start, crossed, hits);
+            for(int t : crossed)
+                occupancy.addMiss(t);
+            for(int t : hits)
+                occupancy.addHit(t);
+            occupancy.applyBatch(view, flipped);
+            return 0L;
+        });
+        runner.run(s, "logOddsBatch", [&](long&){
+            for(int t : crossed)
+                occupancy.addMiss(t);
+            for(int t : hits)
+                occupancy.addHit(t);
+            occupancy.applyBatch(view, flipped);
+            return 0L;
+        });
+    }
+
+    /// Fleet kinematics: one tick of 4096 cruising robots (RobotStates::advance), all heading to the free goal tile
+    if(runner.enabled("fleetAdvance")){
+        RobotStates fleet;
+        std::vector<int> pending;
+        for(int i = 0; i < 4096; i++){
+            int slot = fleet.add(float(i % 64), float(i / 64), 0.5f);
+            fleet.targetX[slot] = 1e6f;
+            fleet.stepX[slot] = 0.5f;
+            fleet.targetTile[slot] = goal;
+            fleet.flags[slot] = RobotStates::CRUISING;
+        }
+        runner.run(s, "fleetAdvance", [&](long&){fleet.advance(s.grid, pending); return 0L;});
+    }
+
+    if(runner.enabled("robotUpdate")){
+        /// The first tick plans the whole path; the timed ticks are the steady state (moving, sensing, replanning)
+        robot.setCanRunAlgo(true);
+        robot.update();
+        runner.run(s, "robotUpdate", [&](long& ops){
+            long before = robot.getPlannerTotals().expanded;
+            for(ops = 0; ops < 1000 && robot.isRunning(); ops++)
+                robot.update();
+            return robot.getPlannerTotals().expanded - before;
+        });
+    }
+}
+
+}
+
+/**
+ * Benchmark entry point: times the hot paths of the core on generated maps.
+ *
+ * Usage: RobotSimBench [--max-cells N] [--min-time S] [--filter OP] [--out FILE]
+ *  - max-cells: skip the map sizes with more tiles (default: every size up to 4096x4096)
+ *  - min-time:  seconds each benchmark repeats its operation for (default 0.2)
+ *  - filter:    only run the operations whose name contains OP
+ *  - out:       write the results to FILE, as CSV (.csv) or JSON (any other extension)
+ *
+ * Maps are random (20% obstacles), perfect mazes and open fields, from 16x12 (the 800x600 window)
+ * to 4096x4096. Maps above 1M tiles are tile-less; above 4M tiles the benchmarks that store data per
+ * edge or per landmark (buildGraph, landmarks) are skipped.
+ */
+int main(int argc, char** argv)
+{
+    long maxCells = 4096L * 4096L;
+    double minTime = 0.2;
+    std::string filter;
+    std::string outPath;
+    for(int i = 1; i + 1 < argc; i += 2){
+        if(std::strcmp(argv[i], "--max-cells") == 0) maxCells = std::atol(argv[i+1]);
+        else if(std::strcmp(argv[i], "--min-time") == 0) minTime = std::atof(argv[i+1]);
+        else if(std::strcmp(argv[i], "--filter") == 0) filter = argv[i+1];
+        else if(std::strcmp(argv[i], "--out") == 0) outPath = argv[i+1];
+        else{
+            std::cerr << "Unknown option " << argv[i] << "\n";
+            return 1;
+        }
+    }
+
+    const int sizes[][2] = {{16, 12}, {64, 48}, {256, 192}, {1024, 768}, {4096, 4096}};
+    const char * families[] = {"random", "maze", "open"};
+    Runner runner(minTime, filter);
+    WorkerPool pool;
+    for(const auto& size : sizes){
+        if(long(size[0]) * size[1] > maxCells)
+            continue;
+        for(const char * family : families)
+            benchmarkScenario(runner, makeScenario(family, size[0], size[1]), pool);
+    }
+
+    if(!outPath.empty()){
+        std::ofstream out(outPath);
+        if(!out){
+            std::cerr << "Cannot write " << outPath << "\n";
+            return 1;
+        }
+        bool csv = outPath.size() > 4 && outPath.compare(outPath.size() - 4, 4, ".csv") == 0;
+        if(csv)
+            writeCsv(out, runner.getResults());
+        else
+            writeJson(out, runner.getResults());
+        std::cout << "Results written to " << outPath << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,412 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include "Map.h"
+#include "MapFile.h"
+#include "Robot.h"
+#include "PlannerType.h"
+#include "World.h"
+#include "SimClock.h"
+#include "Metrics.h"
+#include "Trace.h"
+#include "ScenarioGenerator.h"
+#include "MultiAgentPlanner.h"
+
+/**
+ * Headless entry point: runs one scenario without any window, stepping Robot::update as fast as the CPU allows.
+ *
+ * Usage: RobotSimHeadless [--cols N] [--rows N] [--density P] [--seed S] [--ticks N] [--planner NAME]
+ *                         [--robots N] [--threads N] [--rays N] [--range N]
+ *                         [--map FILE | --import FILE] [--save FILE] [--metrics FILE] [--metrics-every N]
+ *                         [--trace FILE] [--belief MODEL] [--false-hits P] [--missed-hits P] [--terrain 0|1]
+ *                         [--mapf MODE] [--async 0|1] [--events 0|1]
+ *  - cols/rows: grid size in tiles (default 16x12, the size of the 800x600 window)
+ *  - density:   probability for each tile to be an obstacle on the true map (default 0.2)
+ *  - seed:      random seed used to place the obstacles (default 1)
+ *  - ticks:     maximum number of update ticks (default 10000)
+ *  - planner:   dijkstra, astar, jps, dstar, hpa, dial or alt (default dstar)
+ *  - robots:    number of robots (default 1). With more than one robot a World steps the fleet in parallel
+ *  - threads:   threads used to step the fleet (default 0 = one per hardware thread)
+ *  - rays/range: range scanner of each robot (default 0 = only the adjacent-tile sensors)
+ *  - map:       binary map file (see MapFile) used instead of a random map; it is memory mapped
+ *  - import:    text (.txt) or PGM (.pgm) map used instead of a random map
+ *  - save:      writes the true map to a binary map file before running
+ *  - metrics:   writes the run metrics (see MetricsRegistry) to FILE at the end, as CSV (.csv) or JSON
+ *  - metrics-every: also appends a snapshot every N ticks (CSV rows or JSON lines)
+ *  - trace:     records the run to a binary trace (see TraceRecorder), replayed by the viewer with --replay
+ *  - belief:    binary or logodds (default binary): how the robots turn range readings into their belief map
+ *  - false-hits/missed-hits: range scanner noise (see RayScanner::setNoise), each robot with its own stream
+ *  - terrain:   1 adds seeded tile costs (ScenarioGenerator::terrainCosts) to a generated map; a loaded map keeps
+ *               the cost layer of its file. Robots know the costs; dijkstra, astar and dial use them
+ *  - mapf:      prioritized or cbs: plans the fleet together on the true map (World::planCooperative) so robots
+ *               do not collide; start and goal tiles are then distinct. Independent paths are counted for comparison
+ *  - async:     1 runs the searches of a single robot on a background thread (Robot::setAsyncPlanning): the
+ *               longest tick no longer includes a search, but the run is not reproducible tick for tick. A robot
+ *               with no safe tile left waits for the worker outside the ticks (Robot::waitForPlan)
+ *  - events:    1 runs event-driven (World::setEventDriven, Robot::run): the ticks where robots only move between
+ *               tiles are skipped, with the same outcome as fixed steps. Not with --trace, which records every tick
+ *
+ * A single robot goes from the top-left corner to the bottom-right corner
+ * (on a loaded map, from the first free tile to the last one).
+ * Fleet robots get random free start and goal tiles (drawn from the same seed).
+ */
+int main(int argc, char** argv)
+{
+    int cols = 16;
+    int rows = 12;
+    double density = 0.2;
+    unsigned seed = 1;
+    long maxTicks = 10000;
+    PlannerType planner = PlannerType::DStarLite;
+    int robotCount = 1;
+    int threads = 0;
+    int rays = 0;
+    int range = 0;
+    std::string mapPath;
+    std::string importPath;
+    std::string savePath;
+    std::string metricsPath;
+    long metricsEvery = 0;
+    std::string tracePath;
+    BeliefModel belief = BeliefModel::Binary;
+    double falseHits = 0.0;
+    double missedHits = 0.0;
+    bool terrain = false;
+    bool cooperative = false;
+    bool async = false;
+    bool events = false;
+    MultiAgentMode mapfMode = MultiAgentMode::Prioritized;
+
+    for(int i = 1; i + 1 < argc; i += 2){
+        if(std::strcmp(argv[i], "--cols") == 0) cols = std::atoi(argv[i+1]);
+        else if(std::strcmp(argv[i], "--rows") == 0) rows = std::atoi(argv[i+1]);
+        else if(std::strcmp(argv[i], "--density") == 0) density = std::atof(argv[i+1]);
+        else if(std::strcmp(argv[i], "--seed") == 0) seed = unsigned(std::atol(argv[i+1]));
+        else if(std::strcmp(argv[i], "--ticks") == 0) maxTicks = std::atol(argv[i+1]);
+        else if(std::strcmp(argv[i], "--robots") == 0) robotCount = std::atoi(argv[i+1]);
+        else if(std::strcmp(argv[i], "--threads") == 0) threads = std::atoi(argv[i+1]);
+        else if(std::strcmp(argv[i], "--rays") == 0) rays = std::atoi(argv[i+1]);
+        else if(std::strcmp(argv[i], "--range") == 0) range = std::atoi(argv[i+1]);
+        else if(std::strcmp(argv[i], "--map") == 0) mapPath = argv[i+1];
+        else if(std::strcmp(argv[i], "--import") == 0) importPath = argv[i+1];
+        else if(std::strcmp(argv[i], "--save") == 0) savePath = argv[i+1];
+        else if(std::strcmp(argv[i], "--metrics") == 0) metricsPath = argv[i+1];
+        else if(std::strcmp(argv[i], "--metrics-every") == 0) metricsEvery = std::atol(argv[i+1]);
+        else if(std::strcmp(argv[i], "--trace") == 0) tracePath = argv[i+1];
+        else if(std::strcmp(argv[i], "--false-hits") == 0) falseHits = std::atof(argv[i+1]);
+        else if(std::strcmp(argv[i], "--missed-hits") == 0) missedHits = std::atof(argv[i+1]);
+        else if(std::strcmp(argv[i], "--terrain") == 0) terrain = std::atoi(argv[i+1]) != 0;
+        else if(std::strcmp(argv[i], "--async") == 0) async = std::atoi(argv[i+1]) != 0;
+        else if(std::strcmp(argv[i], "--events") == 0) events = std::atoi(argv[i+1]) != 0;
+        else if(std::strcmp(argv[i], "--belief") == 0){
+            if(!beliefModelFromString(argv[i+1], belief)){
+                std::cerr << "Unknown belief model " << argv[i+1] << "\n";
+                return 1;
+            }
+        }
+        else if(std::strcmp(argv[i], "--mapf") == 0){
+            if(!multiAgentModeFromString(argv[i+1], mapfMode)){
+                std::cerr << "Unknown multi-agent mode " << argv[i+1] << "\n";
+                return 1;
+            }
+            cooperative = true;
+        }
+        else if(std::strcmp(argv[i], "--planner") == 0){
+            if(std::strcmp(argv[i+1], "dijkstra") == 0) planner = PlannerType::Dijkstra;
+            else if(std::strcmp(argv[i+1], "astar") == 0) planner = PlannerType::AStar;
+            else if(std::strcmp(argv[i+1], "jps") == 0) planner = PlannerType::JumpPoint;
+            else if(std::strcmp(argv[i+1], "dstar") == 0) planner = PlannerType::DStarLite;
+            else if(std::strcmp(argv[i+1], "hpa") == 0) planner = PlannerType::Hierarchical;
+            else if(std::strcmp(argv[i+1], "dial") == 0) planner = PlannerType::Dial;
+            else if(std::strcmp(argv[i+1], "alt") == 0) planner = PlannerType::Landmarks;
+            else{
+                std::cerr << "Unknown planner " << argv[i+1] << "\n";
+                return 1;
+            }
+        }
+        else{
+            std::cerr << "Unknown option " << argv[i] << "\n";
+            return 1;
+        }
+    }
+    if(cols <= 0 || rows <= 0 || robotCount <= 0){
+        std::cerr << "Grid size and robot count must be positive\n";
+        return 1;
+    }
+    if(events && !tracePath.empty()){
+        std::cerr << "--trace records every tick: it needs --events 0\n";
+        return 1;
+    }
+    if(events && async){
+        std::cerr << "--async runs are not reproducible tick for tick: they need --events 0\n";
+        return 1;
+    }
+
+    /// Ticks are fixed steps of the simulation clock: the headless runner plays them back to back
+    SimClock simClock;
+
+    /// Metrics of the run; periodic snapshots are appended to the same file, then the final one
+    MetricsRegistry metrics;
+    bool firstSnapshot = true;
+    auto snapshot = [&](long tick){
+        if(metricsPath.empty())
+            return;
+        metrics.dump(metricsPath, tick, !firstSnapshot);
+        firstSnapshot = false;
+    };
+
+    /// Trace of the run: capture(t) records every robot after tick t (tick 0 = initial state)
+    TraceRecorder trace;
+    double traceSeconds = 0.0; /// Wall time spent recording
+    auto capture = [&](long t, int count, const std::function<Robot&(int)>& robotAt){
+        if(!trace.isOpen())
+            return;
+        auto begin = std::chrono::steady_clock::now();
+        trace.beginTick(t);
+        for(int i = 0; i < count; i++)
+            trace.captureRobot(i, robotAt(i));
+        trace.endTick();
+        traceSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    };
+    auto traceReport = [&](){
+        if(!trace.isOpen())
+            return;
+        trace.close();
+        std::cout << "Trace: " << tracePath << "  " << trace.getBytesWritten() << " bytes"
+                  << "  recording time: " << traceSeconds * 1000.0 << " ms\n";
+    };
+
+    /// ------------------------ True map ------------------------
+    Map map;
+    int startTile = 0;
+    int goalTile = 0;
+    std::mt19937 rng(seed);
+    MapFile mapFile;
+
+    if(!mapPath.empty() || !importPath.empty()){
+        auto begin = std::chrono::steady_clock::now();
+        if(!mapPath.empty()){
+            if(!mapFile.open(mapPath))
+                return 1;
+            map = mapFile.toMap();
+        }
+        else{
+            GridGraph occupancy;
+            bool isPgm = importPath.size() > 4 && importPath.compare(importPath.size() - 4, 4, ".pgm") == 0;
+            if(!(isPgm ? MapFile::importPGM(importPath, occupancy) : MapFile::importText(importPath, occupancy)))
+                return 1;
+            map = Map::fromOccupancy(occupancy);
+        }
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+        cols = map.getCols();
+        rows = map.getRows();
+        std::cout << "Loaded " << cols << "x" << rows << " map in " << ms << " ms\n";
+
+        startTile = 0;
+        while(startTile < rows * cols && map.getGrid().isBlocked(startTile))
+            startTile++;
+        goalTile = rows * cols - 1;
+        while(goalTile > startTile && map.getGrid().isBlocked(goalTile))
+            goalTile--;
+        if(startTile >= goalTile){
+            std::cerr << "The map needs at least two free tiles\n";
+            return 1;
+        }
+    }
+    else{
+        map = Map::fromGrid(cols, rows);
+        goalTile = rows * cols - 1;
+        std::bernoulli_distribution isObstacle(density);
+        for(int i = 0; i < rows * cols; i++){
+            if(i != startTile && i != goalTile && isObstacle(rng))
+                map.setTileType(i, TileType::Obstacle);
+        }
+        if(terrain)
+            map.setCosts(ScenarioGenerator::terrainCosts(cols, rows, seed));
+    }
+
+    if(!savePath.empty() && !MapFile::save(savePath, map))
+        return 1;
+
+    /// ------------------------ Fleet ------------------------
+    if(robotCount > 1){
+        World world(&map, threads);
+        world.setMetrics(metricsPath.empty() ? nullptr : &metrics);
+        std::uniform_int_distribution<int> anyTile(0, rows * cols - 1);
+        std::vector<char> taken(cooperative ? std::size_t(rows) * cols * 2 : 0, 0); /// Starts, then goals (cooperative runs)
+        auto randomFreeTile = [&](int kind){
+            int t = anyTile(rng);
+            while(map.getGrid().isBlocked(t) || (cooperative && taken[std::size_t(kind) * rows * cols + t]))
+                t = anyTile(rng);
+            if(cooperative)
+                taken[std::size_t(kind) * rows * cols + t] = 1;
+            return t;
+        };
+        if(cooperative && robotCount > rows * cols / 2){
+            std::cerr << "Too many robots for distinct start and goal tiles\n";
+            return 1;
+        }
+        for(int i = 0; i < robotCount; i++){
+            int s = randomFreeTile(0);
+            int g = randomFreeTile(1);
+            Robot& r = world.addRobot(s, g, planner);
+            r.setRangeScan(rays, range);
+            r.setScanNoise(falseHits, missedHits, seed + unsigned(i));
+            r.setBeliefModel(belief);
+            r.setDiscoveryLog(!tracePath.empty());
+        }
+        if(cooperative){
+            /// Independent shortest paths, as the robots would plan them alone, for comparison
+            std::vector<std::vector<int>> independent;
+            for(int i = 0; i < robotCount; i++){
+                Robot& r = world.getRobot(i);
+                independent.push_back(map.aStar(r.getCurrentTile(), r.getEndTile()));
+            }
+            const MultiAgentStats& team = world.planCooperative(mapfMode);
+            std::vector<std::vector<int>> planned;
+            for(int i = 0; i < robotCount; i++)
+                planned.push_back(world.getRobot(i).getPath());
+            std::cout << "MAPF: " << multiAgentModeToString(mapfMode) << (team.fellBack ? " (fell back to prioritized)" : "")
+                      << "  solved: " << team.solved << "/" << team.agents
+                      << "  sum of costs: " << team.sumOfCosts
+                      << "  makespan: " << team.makespan
+                      << "  search time: " << team.milliseconds << " ms"
+                      << "  searches: " << team.searches
+                      << "  expanded: " << team.lowLevel.expanded << "\n"
+                      << "Conflicts: " << MultiAgentPlanner::countConflicts(planned) << " planned, "
+                      << MultiAgentPlanner::countConflicts(independent) << " with independent shortest paths\n";
+        }
+        auto fleetRobot = [&](int i) -> Robot& {return world.getRobot(i);};
+        if(!tracePath.empty() && !trace.open(tracePath, map, robotCount, world.getRobot(0).getRadius()))
+            return 1;
+        capture(0, robotCount, fleetRobot);
+
+        auto begin = std::chrono::steady_clock::now();
+        long ticks = 0;
+        world.setEventDriven(events);
+        while(ticks < maxTicks && world.getRunningCount() > 0){
+            if(events){
+                /// Up to the next metrics snapshot at most
+                long chunk = maxTicks - ticks;
+                if(metricsEvery > 0)
+                    chunk = std::min(chunk, metricsEvery - ticks % metricsEvery);
+                ticks += world.run(chunk);
+            }
+            else{
+                world.step();
+                ticks++;
+                capture(ticks, robotCount, fleetRobot);
+            }
+            if(metricsEvery > 0 && ticks % metricsEvery == 0)
+                snapshot(ticks);
+        }
+        auto end = std::chrono::steady_clock::now();
+        double ms = std::chrono::duration<double, std::milli>(end - begin).count();
+
+        int reached = 0;
+        long replans = 0;
+        long cleared = 0;
+        SearchStats totals;
+        for(int i = 0; i < world.getRobotCount(); i++){
+            const Robot& r = world.getRobot(i);
+            reached += r.hasReachedGoal() ? 1 : 0;
+            replans += r.getReplans();
+            cleared += r.getClearedTiles();
+            totals += r.getPlannerTotals();
+        }
+        std::cout << "Grid: " << cols << "x" << rows
+                  << "  robots: " << robotCount
+                  << "  threads: " << world.getThreadCount()
+                  << "  ticks: " << ticks
+                  << "  goals reached: " << reached << "/" << robotCount
+                  << "  wall time: " << ms << " ms\n"
+                  << "Sim time: " << ticks * simClock.getStepSeconds() << " s"
+                  << "  throughput: " << (ms > 0 ? ticks * simClock.getStepSeconds() / (ms / 1000.0) : 0.0) << " sim-s/s\n"
+                  << "Planner: " << plannerTypeToString(planner)
+                  << "  path computations: " << replans
+                  << "  nodes expanded: " << totals.expanded
+                  << "  pushed: " << totals.pushed << "\n";
+        std::size_t beliefBytes = world.getBeliefMemoryBytes();
+        std::cout << "Belief maps: " << beliefBytes / 1024 << " KB (" << beliefBytes / robotCount << " B per robot, prior shared)\n";
+        if(belief == BeliefModel::LogOdds)
+            std::cout << "Belief: logodds  obstacles cleared: " << cleared << "\n";
+        snapshot(ticks);
+        traceReport();
+        return reached == robotCount ? 0 : 2;
+    }
+
+    /// ------------------------ Robot ------------------------
+    Robot robot(&map, 0, 0, 25);
+    robot.placeRobot(startTile % cols, startTile / cols);
+    robot.setStartTile(startTile);
+    robot.setEndTile(goalTile);
+    robot.setPlannerType(planner);
+    robot.setRangeScan(rays, range);
+    robot.setScanNoise(falseHits, missedHits, seed);
+    robot.setBeliefModel(belief);
+    robot.setAsyncPlanning(async);
+    if(!metricsPath.empty())
+        robot.setMetrics(&metrics, 0);
+    robot.setDiscoveryLog(!tracePath.empty());
+    robot.setCanRunAlgo(true);
+    auto singleRobot = [&](int) -> Robot& {return robot;};
+    if(!tracePath.empty() && !trace.open(tracePath, map, 1, robot.getRadius()))
+        return 1;
+    capture(0, 1, singleRobot);
+
+    /// ------------------------ Simulation loop ------------------------
+    auto begin = std::chrono::steady_clock::now();
+    long ticks = 0;
+    double longestTick = 0.0;
+    double waited = 0.0; /// Time spent waiting for the worker (async planning)
+    while(robot.isRunning() && ticks < maxTicks){
+        if(events){
+            long chunk = maxTicks - ticks;
+            if(metricsEvery > 0)
+                chunk = std::min(chunk, metricsEvery - ticks % metricsEvery);
+            ticks += robot.run(chunk);
+        }
+        else{
+            /// Ticks played back to back would all pass while a search runs: wait for it between two ticks
+            auto waitBegin = std::chrono::steady_clock::now();
+            robot.waitForPlan();
+            auto tickBegin = std::chrono::steady_clock::now();
+            waited += std::chrono::duration<double, std::milli>(tickBegin - waitBegin).count();
+            robot.update();
+            longestTick = std::max(longestTick, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - tickBegin).count());
+            ticks++;
+            capture(ticks, 1, singleRobot);
+        }
+        if(metricsEvery > 0 && ticks % metricsEvery == 0)
+            snapshot(ticks);
+    }
+    auto end = std::chrono::steady_clock::now();
+    double ms = std::chrono::duration<double, std::milli>(end - begin).count();
+
+    std::cout << "\nGrid: " << cols << "x" << rows
+              << "  ticks: " << ticks
+              << "  goal reached: " << (robot.hasReachedGoal() ? "yes" : "no")
+              << "  wall time: " << ms << " ms\n"
+              << "Sim time: " << ticks * simClock.getStepSeconds() << " s"
+              << "  throughput: " << (ms > 0 ? ticks * simClock.getStepSeconds() / (ms / 1000.0) : 0.0) << " sim-s/s\n"
+              << "Planner: " << plannerTypeToString(planner)
+              << "  path computations: " << robot.getReplans()
+              << "  nodes expanded: " << robot.getPlannerTotals().expanded
+              << "  pushed: " << robot.getPlannerTotals().pushed << "\n"
+              << (events ? std::string("Event-driven run") : "Longest tick: " + std::to_string(longestTick) + " ms")
+              << (async ? "  (async planning, " + std::to_string(robot.getCancelledPlans()) + " stale searches dropped, "
+                          + std::to_string(waited) + " ms waiting for the worker)" : std::string()) << "\n"
+              << "Belief map + planner state: " << robot.getBeliefMemoryBytes() / 1024 << " KB"
+              << (robot.getRobotMap()->getGrid().isChunked() ? " (chunked)" : "") << "\n";
+    if(belief == BeliefModel::LogOdds)
+        std::cout << "Belief: logodds  tile updates: " << robot.getOccupancy().getUpdates()
+                  << "  obstacles cleared: " << robot.getClearedTiles() << "\n";
+    snapshot(ticks);
+    traceReport();
+    return robot.hasReachedGoal() ? 0 : 2;
+}
@@ -2,6 +2,14 @@
 #include <cmath>
 #include "Map.h"
 #include "Robot.h"
+#include "SfmlView.h"
+#include "TileRenderer.h"
+#include "LabelLayer.h"
+#include "SimClock.h"
+#include "MapFile.h"
+#include "ReplayView.h"
+#include <string>
+#include <sstream>
 #include "Utils.h"
 /**
  * Entry point of the simulation. Initializes windows, map, and robot, and handles user interaction.
@@ -12,9 +20,17 @@
  *  - One for the robot's internal map
  * 
  *  The robot navigates from start to goal using a pathfinding algorithm (e.g., Dijkstra).
+ *
+ *  An optional argument names a binary map file (see MapFile) whose obstacles are loaded on the
+ *  true map; 'S' saves the true map to map.rsm.
+ *
+ *  "--replay TRACE" plays back a trace recorded by RobotSimHeadless --trace instead (see runReplay).
  */
-int main()
+int main(int argc, char** argv)
 {
+    if(argc > 2 && std::string(argv[1]) == "--replay")
+        return runReplay(argv[2]);
+
     std::cout<<"Hello\n";
 
     /// ----------------------- Window setup -----------------------
@@ -23,6 +39,8 @@ int main()
     sf::RenderWindow window1(sf::VideoMode(windowsWidth, windowsHeigt), "True Map");
     sf::RenderWindow window2(sf::VideoMode(windowsWidth, windowsHeigt), "Robot Map");
     sf::Color colorBackGround = sf::Color::Black;
+    window1.setFramerateLimit(60);
+    window2.setFramerateLimit(60);
 
     /// ------------------------ Font loading ------------------------
     sf::Font font;
@@ -40,10 +58,41 @@ int main()
 
     /// ------------------------ Map & Robot -------------------------
     Map map(windowsWidth, windowsHeigt);
-    auto& tiles = map.getTiles();
+    const auto& tiles = map.getTiles();
+
+    if(argc > 1){
+        MapFile mapFile;
+        if(mapFile.open(argv[1])){
+            if(mapFile.getCols() == map.getCols() && mapFile.getRows() == map.getRows()){
+                const GridGraph& occupancy = mapFile.getOccupancy();
+                for(int i = 0; i < occupancy.size(); i++)
+                    if(occupancy.isBlocked(i))
+                        map.setTileType(i, TileType::Obstacle);
+                std::cout << "Loaded " << argv[1] << "\n";
+            }
+            else
+                std::cout << argv[1] << " is " << mapFile.getCols() << "x" << mapFile.getRows()
+                          << ", the window shows " << map.getCols() << "x" << map.getRows() << " tiles\n";
+        }
+    }
 
-    Robot robot(&map, 0,0,25, &window1);
+    Robot robot(&map, 0,0,25);
     Map * rMap = robot.getRobotMap();
+    rMap->createTiles(); /// The belief map is tile-less: the second window draws tiles
+    robot.setAsyncPlanning(true); /// Searches run on a worker thread: a replan never stalls the frame
+
+    /// One vertex array per map, patched only where tiles change
+    TileRenderer trueMapView(&map);
+    TileRenderer robotMapView(rMap);
+
+    /// Tile indices (same grid in both windows), toggled with 'L'
+    LabelLayer labels(font);
+
+    /// ------------------------ Simulation clock ------------------------
+    /// Fixed steps decoupled from the frame rate: '+'/'-' change the fast-forward factor, 'U' toggles uncapped mode
+    SimClock simClock;
+    sf::Clock frameClock;
+    sf::Clock titleClock;
 
     int xR, yR, colR, rowR;
     bool robotPlaced = false; 
@@ -71,7 +120,7 @@ int main()
                     int index = row*map.getCols()+col;
                     /// Starting point 
                     if(clickStage == 0){
-                        tiles[index].setFillColor(sf::Color::Magenta);
+                        map.setTileFillColor(index, Color::Magenta);
                         std::cout << "Start set on tile: " << index << "\n";
                         startTile = index;
                         rowR = startTile / map.getCols();
@@ -81,7 +130,7 @@ int main()
                     }
                     /// Goal point
                     else if(clickStage == 1){
-                        tiles[index].setFillColor(sf::Color::Green);
+                        map.setTileFillColor(index, Color::Green);
                         std::cout << "Goal set on tile: " << index << "\n";
                         goalTile = index;
                         robot.setEndTile(goalTile);
@@ -89,8 +138,8 @@ int main()
                     /// Obstacle
                     else{
                         if(tiles[index].getType() != TileType::Obstacle){
-                            tiles[index].setType(TileType::Obstacle);
-                            tiles[index].setFillColor(sf::Color::Black);
+                            map.setTileType(index, TileType::Obstacle);
+                            map.setTileFillColor(index, Color::Black);
                             std::cout << "Tile " << index << " set as obstacle\n";
                         }
                     }
@@ -106,8 +155,8 @@ int main()
                 if(col >= 0 && col<map.getCols() && row >= 0 && row < map.getRows()){
                     int index = row*map.getCols()+col; 
                     if(tiles[index].getType() == TileType::Obstacle){
-                        tiles[index].setType(TileType::Empty);
-                        tiles[index].setFillColor(sf::Color::White);
+                        map.setTileType(index, TileType::Empty);
+                        map.setTileFillColor(index, Color::White);
                         std::cout << "Tile " << index << " is not an obstacle anymore\n";
                     }
                 }
@@ -116,12 +165,32 @@ int main()
             if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::E && clickStage>=1)
                 robot.setCanRunAlgo(true);
 
+            /// -------- Key press: 'L' shows/hides the tile indices --------
+            if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::L)
+                labels.toggle();
+
+            /// -------- Key press: 'S' saves the true map --------
+            if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::S && MapFile::save("map.rsm", map))
+                std::cout << "Map saved to map.rsm\n";
+
+            /// -------- Key press: simulation speed --------
+            if (event.type == sf::Event::KeyPressed){
+                if(event.key.code == sf::Keyboard::Add || event.key.code == sf::Keyboard::Equal)
+                    simClock.setMultiplier(simClock.getMultiplier() * 2.0);
+                if(event.key.code == sf::Keyboard::Subtract || event.key.code == sf::Keyboard::Hyphen)
+                    simClock.setMultiplier(simClock.getMultiplier() / 2.0);
+                if(event.key.code == sf::Keyboard::U)
+                    simClock.setUncapped(!simClock.isUncapped());
+            }
+
         }
 
         /// =========== Handle events in window2 ===========
         while(window2.pollEvent(event)){
             if(event.type==sf::Event::Closed)
                 window2.close();
+            if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::L)
+                labels.toggle();
         }
 
         /// =========== Rendering ===========
@@ -131,51 +200,32 @@ int main()
 
 
         /// Draw full map in window1      
-        map.draw(window1);
-
-        /// Update and draw robot
-        robot.update(window1);
+        trueMapView.update();
+        window1.draw(trueMapView);
+
+        /// Run the fixed simulation steps due for this frame, then draw the robot
+        simClock.advance(frameClock.restart().asSeconds(), [&]{ robot.update(); });
+        drawRobot(robot, window1);
+
+        if(titleClock.getElapsedTime().asSeconds() > 0.5f){
+            titleClock.restart();
+            std::ostringstream title;
+            title << "True Map - ";
+            if(simClock.isUncapped()) title << "uncapped";
+            else title << "x" << simClock.getMultiplier();
+            title << " - " << simClock.getThroughput() << " sim-s/s";
+            window1.setTitle(title.str());
+        }
        
         /// ----- Debugging: draw tile indices -----
-        for (int i = 0; i < tiles.size(); ++i) {
-            sf::Text text;
-            text.setFont(font);
-            text.setString(std::to_string(i));
-            text.setCharacterSize(12);
-            text.setFillColor(sf::Color::Red);
-
-            sf::FloatRect tileBounds = tiles[i].getGlobalBounds();
-            sf::FloatRect textBounds = text.getLocalBounds();
-
-            float x = tileBounds.left + (tileBounds.width - textBounds.width) / 2.f;
-            float y = tileBounds.top + (tileBounds.height - textBounds.height) / 2.f;
-
-            text.setPosition(x, y);
-            window1.draw(text);  
-        }
+        labels.update(map);
+        window1.draw(labels);
 
         /// ----- Draw robot's internal map (rMap) -----
-        robot.getRobotMap()->draw(window2);
-
-        const std::vector<Tile>& robotTiles = robot.getRobotMap()->getTiles();
-
-        for (int i = 0; i < robotTiles.size(); ++i) {
-            sf::Text text;
-            text.setFont(font);
-            text.setString(std::to_string(i));
-            text.setCharacterSize(12);
-            text.setFillColor(sf::Color::Red);
-
-            sf::FloatRect tileBounds = robotTiles[i].getGlobalBounds();
-            sf::FloatRect textBounds = text.getLocalBounds();
-
-            float x = tileBounds.left + (tileBounds.width - textBounds.width) / 2.f;
-            float y = tileBounds.top + (tileBounds.height - textBounds.height) / 2.f;
-
-            text.setPosition(x, y);
-            window2.draw(text);
-        }
+        robotMapView.update();
+        window2.draw(robotMapView);
 
+        window2.draw(labels);
 
         window2.display();
         window1.display();